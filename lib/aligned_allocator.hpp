@@ -0,0 +1,37 @@
+#ifndef LIB_ALIGNED_ALLOCATOR_HPP
+#define LIB_ALIGNED_ALLOCATOR_HPP 1
+
+#include <new>
+
+#include <lib/prelude.hpp>
+
+// Allocator for std::vector whose storage starts on an A-byte boundary, a cache line by default
+template <typename T, usize A = 64>
+struct aligned_allocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = aligned_allocator<U, A>;
+    };
+
+    aligned_allocator() {}
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, A> &) {}
+
+    T *allocate(usize k) {
+        return static_cast<T *>(::operator new(k * sizeof(T), std::align_val_t(A)));
+    }
+
+    void deallocate(T *p, usize) {
+        ::operator delete(p, std::align_val_t(A));
+    }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, A> &) const {
+        return true;
+    }
+};
+
+#endif // LIB_ALIGNED_ALLOCATOR_HPP
@@ -23,7 +23,16 @@ struct arbitrary_montgomery_modint_base {
 
     template <typename T, std::enable_if_t<std::is_integral<T>::value> * = nullptr>
     arbitrary_montgomery_modint_base(T x)
-        : v(reduce(V(x % m + m) * n2)) {}
+        : v(reduce(lift(x) * n2)) {}
+
+    // x mod m shifted into [m, 2m), without letting a signed x wrap through U
+    template <typename I>
+    static V lift(I x) {
+        if constexpr (std::is_signed_v<I>)
+            return V(T(x) % T(m) + T(m));
+        else
+            return V(x % m + m);
+    }
 
     static U reduce(V b) {
         return static_cast<U>((b + V(U(b) * U(-r)) * m) >> W);
@@ -0,0 +1,17 @@
+#ifndef LIB_BATCH_OPERATION_HPP
+#define LIB_BATCH_OPERATION_HPP 1
+
+#include <lib/prelude.hpp>
+
+// One operation of a batch for the point-update range-product structures:
+// set(l, x), multiply(l, x) or prod(l, r)
+enum class batch_op { set, multiply, prod };
+
+template <typename X>
+struct batch_operation {
+    batch_op type;
+    i32 l, r;
+    X x;
+};
+
+#endif // LIB_BATCH_OPERATION_HPP
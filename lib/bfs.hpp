@@ -0,0 +1,171 @@
+#ifndef LIB_BFS_HPP
+#define LIB_BFS_HPP 1
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <vector>
+
+#include <lib/bits.hpp>
+#include <lib/limits.hpp>
+#include <lib/prelude.hpp>
+
+// Distances from s, inf<i32> where unreachable; rg must have the reverse edges of g (g itself if
+// it is undirected, csr_graph::reverse otherwise)
+// Direction-optimizing: a small frontier pushes along the edges of g, a large one is kept as a
+// bitmap and every unvisited vertex pulls along rg until it finds a frontier vertex, which skips
+// most edges once the bulk of the graph is reached
+template <typename Graph>
+inline std::vector<i32> bfs(const Graph &g, const Graph &rg, i32 s) {
+    constexpr i64 ALPHA = 14, BETA = 24;
+
+    const i32 n = static_cast<i32>(g.size());
+    assert(0 <= s && s < n);
+
+    const usize w = (static_cast<usize>(n) + 63) / 64;
+    const auto bit = [](i32 v) -> u64 { return u64(1) << (v & 63); };
+
+    std::vector<i32> dst(n, inf<i32>), q{s}, nq;
+    std::vector<u64> vis(w), cur(w), nxt(w);
+
+    dst[s] = 0;
+    vis[s >> 6] |= bit(s);
+
+    // Edges out of the frontier and into the unvisited vertices, to pick the direction
+    i64 mf = static_cast<i64>(g[s].size()), mu = 0;
+    for (i32 v = 0; v < n; ++v)
+        if (v != s) mu += static_cast<i64>(rg[v].size());
+
+    bool bottom = false;
+    for (i32 d = 1, nf = 1; nf > 0; ++d) {
+        if (!bottom && mf > mu / ALPHA) {
+            bottom = true;
+
+            std::fill(cur.begin(), cur.end(), 0);
+            for (const i32 u : q) cur[u >> 6] |= bit(u);
+        } else if (bottom && nf < n / BETA) {
+            bottom = false;
+
+            q.clear();
+            for (usize i = 0; i < w; ++i)
+                for (u64 x = cur[i]; x != 0; x &= x - 1) q.push_back(static_cast<i32>(i << 6 | lowbit(x)));
+        }
+
+        nf = 0;
+        mf = 0;
+
+        if (!bottom) {
+            nq.clear();
+            for (const i32 u : q) {
+                for (const i32 v : g[u]) {
+                    if (vis[v >> 6] & bit(v)) continue;
+
+                    vis[v >> 6] |= bit(v);
+                    dst[v] = d;
+                    nq.push_back(v);
+
+                    mf += static_cast<i64>(g[v].size());
+                    mu -= static_cast<i64>(rg[v].size());
+                }
+            }
+
+            std::swap(q, nq);
+            nf = static_cast<i32>(q.size());
+        } else {
+            std::fill(nxt.begin(), nxt.end(), 0);
+            for (usize i = 0; i < w; ++i) {
+                u64 x = ~vis[i];
+                if (i + 1 == w && n % 64 != 0) x &= bit(n) - 1;
+
+                for (; x != 0; x &= x - 1) {
+                    const i32 v = static_cast<i32>(i << 6 | lowbit(x));
+
+                    for (const i32 u : rg[v]) {
+                        if (!(cur[u >> 6] & bit(u))) continue;
+
+                        dst[v] = d;
+                        nxt[i] |= bit(v);
+                        ++nf;
+
+                        mf += static_cast<i64>(g[v].size());
+                        mu -= static_cast<i64>(rg[v].size());
+                        break;
+                    }
+                }
+            }
+
+            for (usize i = 0; i < w; ++i) vis[i] |= nxt[i];
+            std::swap(cur, nxt);
+        }
+    }
+
+    return dst;
+}
+
+template <typename Graph>
+inline std::vector<i32> bfs(const Graph &g, i32 s) {
+    return bfs(g, g, s);
+}
+
+// Distances from every source in ss along the edges of g, as one array: the distance from ss[i]
+// to v is at i * n + v, inf<i32> where unreachable
+// Sources go in groups of 64, one bit each: a vertex keeps the sources that first reached it in
+// this round and pushes them to its neighbours with one OR, so a group costs about one traversal
+template <typename Graph>
+inline std::vector<i32> bfs_many(const Graph &g, std::span<const i32> ss) {
+    const i32 n = static_cast<i32>(g.size());
+    const usize k = ss.size();
+
+    std::vector<i32> dst(k * n, inf<i32>);
+    std::vector<u64> seen(n), cur(n), nxt(n);
+    std::vector<i32> act, nact;
+
+    for (usize b = 0; b < k; b += 64) {
+        const usize c = std::min<usize>(64, k - b);
+
+        std::fill(seen.begin(), seen.end(), 0);
+        act.clear();
+
+        for (usize j = 0; j < c; ++j) {
+            const i32 s = ss[b + j];
+            assert(0 <= s && s < n);
+
+            if (cur[s] == 0) act.push_back(s);
+
+            cur[s] |= u64(1) << j;
+            seen[s] |= u64(1) << j;
+            dst[(b + j) * n + s] = 0;
+        }
+
+        for (i32 d = 1; !act.empty(); ++d) {
+            nact.clear();
+            for (const i32 u : act) {
+                const u64 x = cur[u];
+                cur[u] = 0;
+
+                for (const i32 v : g[u]) {
+                    const u64 y = x & ~seen[v];
+                    if (y == 0) continue;
+
+                    if (nxt[v] == 0) nact.push_back(v);
+                    nxt[v] |= y;
+                }
+            }
+
+            for (const i32 v : nact) {
+                const u64 y = nxt[v];
+                nxt[v] = 0;
+
+                seen[v] |= y;
+                cur[v] = y;
+                for (u64 x = y; x != 0; x &= x - 1) dst[(b + lowbit(x)) * n + v] = d;
+            }
+
+            std::swap(act, nact);
+        }
+    }
+
+    return dst;
+}
+
+#endif // LIB_BFS_HPP
@@ -3,6 +3,7 @@
 
 #include <vector>
 
+#include <lib/bits.hpp>
 #include <lib/prelude.hpp>
 
 struct bit_vector {
@@ -24,6 +25,32 @@ struct bit_vector {
         for (i32 i = 0; i < static_cast<i32>(d.size()) - 1; ++i) d[i + 1].second = d[i].second + popcnt(d[i].first);
     }
 
+    void prefetch(i32 i) const {
+        __builtin_prefetch(&d[i >> 6]);
+    }
+
+    template <typename Writer>
+    void save(Writer &w) const {
+        w.value(n);
+        w.array(d);
+    }
+
+    // Only the words are taken from the file: the bits from n on are cleared and the counts rebuilt,
+    // so a corrupt file cannot make rank1 leave [0, n]
+    template <typename Reader>
+    bool load(Reader &r) {
+        if (!(r.value(n) && n >= 0 && r.array(d) && static_cast<i64>(d.size()) == (i64(n) + 127) >> 6)) return false;
+
+        for (i32 i = n >> 6; i < static_cast<i32>(d.size()); ++i) {
+            d[i].first &= i == n >> 6 ? (static_cast<u64>(1) << (n & 63)) - 1 : 0;
+            d[i].second = 0;
+        }
+
+        d[0].second = 0;
+        build();
+        return true;
+    }
+
     bool operator[](i32 i) const {
         return d[i >> 6].first >> (i & 63) & 1;
     }
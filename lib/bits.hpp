@@ -1,6 +1,10 @@
 #ifndef LIB_BITS_HPP
 #define LIB_BITS_HPP 1
 
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
 #include <lib/prelude.hpp>
 
 [[gnu::always_inline, nodiscard]] inline constexpr usize popcnt(u32 x) {
@@ -75,4 +79,17 @@
     return lowbit(static_cast<u128>(x));
 }
 
+// Position of the k-th (0-indexed) set bit of x, which must have more than k of them
+[[gnu::always_inline, nodiscard]] inline usize select_bit(u64 x, usize k) {
+#ifdef __BMI2__
+    return lowbit(static_cast<u64>(_pdep_u64(u64(1) << k, x)));
+#else
+    usize b = 0;
+    for (usize c; k >= (c = popcnt((x >> b) & 0xff)); b += 8) k -= c;
+
+    for (x >>= b; k != 0; --k) x &= x - 1;
+    return b + lowbit(x);
+#endif
+}
+
 #endif // LIB_BITS_HPP
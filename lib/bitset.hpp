@@ -607,6 +607,8 @@ public:
     constexpr bitset() = default;
     constexpr bitset(const bitset &other) = default;
     constexpr bitset(bitset &&other) = default;
+    constexpr bitset &operator=(const bitset &other) = default;
+    constexpr bitset &operator=(bitset &&other) = default;
 
     class reference {
     public:
@@ -0,0 +1,158 @@
+#ifndef LIB_BLOCK_SPARSE_TABLE_HPP
+#define LIB_BLOCK_SPARSE_TABLE_HPP 1
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <lib/algebraic_traits.hpp>
+#include <lib/bits.hpp>
+#include <lib/prelude.hpp>
+
+// O(1) range products in about n (sizeof(X) + 8) bytes, for monoids whose op returns one of its
+// operands (min, max, min_idx, ...)
+// The elements are split into blocks of 64; sk[i] has a bit for every j in the block of i, j <= i,
+// with d[j] winning over all of (j, i], so the winner of [l, i] is the lowest such bit >= l
+// A sparse table over the block winners, one flat array with a row of nb per level, covers the
+// whole blocks in between
+template <typename Monoid, is_monoid_t<Monoid> * = nullptr>
+struct block_sparse_table {
+    using MX = Monoid;
+    using X = typename MX::ValueT;
+
+    static constexpr i32 B = 64;
+    static constexpr u32 SERIAL_TAG = 0x54505342; // "BSPT"
+
+    i32 n, nb, log;
+    std::vector<X> d, t;
+    std::vector<u64> sk;
+
+    block_sparse_table() {}
+    explicit block_sparse_table(const std::vector<X> &v) {
+        build(v);
+    }
+
+    template <typename F>
+    block_sparse_table(i32 m, F f) {
+        build(m, f);
+    }
+
+    void build(const std::vector<X> &v) {
+        build(static_cast<i32>(v.size()), [&](i32 i) -> X { return v[i]; });
+    }
+
+    template <typename F>
+    void build(i32 m, F f) {
+        n = m;
+        nb = (n + B - 1) / B;
+
+        d.resize(n);
+        sk.resize(n);
+        for (i32 i = 0; i < n; ++i) d[i] = f(i);
+
+        for (i32 i = 0; i < n; ++i) {
+            const i32 o = i & ~(B - 1);
+
+            u64 s = i == o ? 0 : sk[i - 1];
+            while (s != 0) {
+                const i32 j = o + static_cast<i32>(topbit(s));
+                if (!(MX::op(d[j], d[i]) == d[i])) break;
+
+                s ^= u64(1) << (j - o);
+            }
+
+            sk[i] = s | u64(1) << (i - o);
+        }
+
+        log = 1;
+        while ((1 << log) < nb) ++log;
+
+        t.resize(static_cast<usize>(log) * nb);
+        for (i32 b = 0; b < nb; ++b) t[b] = d[inner(b * B, std::min(n, (b + 1) * B) - 1)];
+
+        for (i32 k = 0; k + 1 < log; ++k) {
+            const X *x = t.data() + static_cast<usize>(k) * nb;
+            X *y = t.data() + static_cast<usize>(k + 1) * nb;
+
+            for (i32 b = 0; b + (2 << k) <= nb; ++b) y[b] = MX::op(x[b], x[b + (1 << k)]);
+        }
+    }
+
+    // See serialize.hpp
+    template <typename Writer>
+    void save(Writer &w) const {
+        w.value(n);
+        w.value(nb);
+        w.value(log);
+        w.array(d);
+        w.array(t);
+        w.array(sk);
+    }
+
+    template <typename Reader>
+    bool load(Reader &r) {
+        if (!(r.value(n) && r.value(nb) && r.value(log) && r.array(d) && r.array(t) && r.array(sk))) return false;
+        if (n < 0 || nb != (i64(n) + B - 1) / B || d.size() != static_cast<usize>(n) || sk.size() != static_cast<usize>(n))
+            return false;
+
+        i32 k = 1;
+        while ((1 << k) < nb) ++k;
+        if (log != k || t.size() != static_cast<usize>(log) * nb) return false;
+
+        // inner needs the bit of i itself set and none above it
+        for (i32 i = 0; i < n; ++i)
+            if (sk[i] >> (i & (B - 1)) != 1) return false;
+
+        return true;
+    }
+
+    // Pulls in the lines a prod(l, r) reads, except the winners inside the end blocks
+    void prefetch(i32 l, i32 r) const {
+        if (r - l < 2) return;
+
+        const i32 bl = l / B, br = (r - 1) / B;
+        __builtin_prefetch(&sk[l]);
+        __builtin_prefetch(&sk[r - 1]);
+
+        if (bl + 1 < br) {
+            const i32 k = static_cast<i32>(topbit(br - bl - 1));
+            const X *y = t.data() + static_cast<usize>(k) * nb;
+
+            __builtin_prefetch(&y[bl + 1]);
+            __builtin_prefetch(&y[br - (1 << k)]);
+        }
+    }
+
+    X get(i32 p) const {
+        assert(0 <= p && p < n);
+
+        return d[p];
+    }
+
+    X prod(i32 l, i32 r) const {
+        assert(0 <= l && l <= r && r <= n);
+
+        if (l == r) return MX::unit();
+
+        const i32 bl = l / B, br = (r - 1) / B;
+        if (bl == br) return d[inner(l, r - 1)];
+
+        X x = d[inner(l, bl * B + B - 1)];
+        if (bl + 1 < br) {
+            const i32 k = static_cast<i32>(topbit(br - bl - 1));
+            const X *y = t.data() + static_cast<usize>(k) * nb;
+
+            x = MX::op(x, MX::op(y[bl + 1], y[br - (1 << k)]));
+        }
+
+        return MX::op(x, d[inner(br * B, r - 1)]);
+    }
+
+private:
+    // Position of the winner of [l, r], both in one block
+    i32 inner(i32 l, i32 r) const {
+        return (r & ~(B - 1)) + static_cast<i32>(lowbit(sk[r] >> (l & (B - 1)) << (l & (B - 1))));
+    }
+};
+
+#endif // LIB_BLOCK_SPARSE_TABLE_HPP
@@ -0,0 +1,179 @@
+#ifndef LIB_BLOCKED_FENWICK_TREE_HPP
+#define LIB_BLOCKED_FENWICK_TREE_HPP 1
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <lib/algebraic_traits.hpp>
+#include <lib/fenwick_tree.hpp>
+#include <lib/prelude.hpp>
+
+// Drop-in replacement for fenwick_tree that keeps the prefix products of every block of B
+// consecutive elements in place and a fenwick_tree over the block totals on top
+// prod reads one local prefix and walks a tree B times smaller, get is two reads, and multiply
+// rewrites the rest of one block (a few cache lines, a loop the compiler vectorizes) before the walk
+template <typename Monoid, is_abelian_group_t<Monoid> * = nullptr>
+struct blocked_fenwick_tree {
+    using MX = Monoid;
+    using X = typename MX::ValueT;
+
+    static constexpr i32 B = static_cast<i32>(std::max<usize>(256 / sizeof(X), 1));
+
+    // p[i] is the product of the elements from the start of the block of i to i inclusive
+    i32 n;
+    std::vector<X> p;
+    fenwick_tree<MX> f;
+
+    blocked_fenwick_tree() {}
+    explicit blocked_fenwick_tree(i32 m) {
+        build(m);
+    }
+
+    explicit blocked_fenwick_tree(const std::vector<X> &v) {
+        build(v);
+    }
+
+    template <typename F>
+    blocked_fenwick_tree(i32 m, F g) {
+        build(m, g);
+    }
+
+    void build(i32 m) {
+        build(m, [](i32) -> X { return MX::unit(); });
+    }
+
+    void build(const std::vector<X> &v) {
+        build(static_cast<i32>(v.size()), [&](i32 i) -> X { return v[i]; });
+    }
+
+    template <typename F>
+    void build(i32 m, F g) {
+        n = m;
+        p.assign(n, MX::unit());
+
+        for (i32 i = 0; i < n; ++i) p[i] = i % B == 0 ? g(i) : MX::op(p[i - 1], g(i));
+        f.build((n + B - 1) / B, [&](i32 b) -> X { return p[std::min(n, (b + 1) * B) - 1]; });
+    }
+
+    X prod_all() const {
+        return f.prod_all();
+    }
+
+    X prod(i32 r) const {
+        assert(0 <= r && r <= n);
+
+        const X x = f.prod(r / B);
+        return r % B == 0 ? x : MX::op(x, p[r - 1]);
+    }
+
+    X prod(i32 l, i32 r) const {
+        assert(0 <= l && l <= r && r <= n);
+
+        if (l / B == r / B) return MX::op(MX::inv(local(l)), local(r));
+        return MX::op(MX::op(MX::inv(local(l)), f.prod(l / B, r / B)), local(r));
+    }
+
+    X get(i32 i) const {
+        assert(0 <= i && i < n);
+
+        return i % B == 0 ? p[i] : MX::op(MX::inv(p[i - 1]), p[i]);
+    }
+
+    void multiply(i32 i, const X &x) {
+        assert(0 <= i && i < n);
+
+        const i32 e = std::min(n, (i / B + 1) * B);
+        for (i32 j = i; j < e; ++j) p[j] = MX::op(p[j], x);
+
+        f.multiply(i / B, x);
+    }
+
+    void set(i32 i, const X &x) {
+        multiply(i, MX::op(MX::inv(get(i)), x));
+    }
+
+    // Same contract as fenwick_tree: f(prod(l, r)) must be monotone in r
+    // The rest of the block of l and the block where f fails are binary searched on the local
+    // prefixes, the whole blocks in between are left to the tree on top
+    template <typename F>
+    i32 max_right(F g, i32 l) const {
+        assert(0 <= l && l <= n && g(MX::unit()));
+        if (l == n) return n;
+
+        const X u = MX::inv(local(l));
+        const auto in_block = [&](i32 lo, i32 hi, const X &s) -> i32 {
+            while (lo < hi) {
+                const i32 mid = (lo + hi) / 2;
+                if (g(MX::op(s, p[mid])))
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            return lo;
+        };
+
+        i32 b = l / B;
+        X s = MX::unit();
+        if (l % B != 0) {
+            const i32 e = std::min(n, (b + 1) * B);
+            if (const i32 r = in_block(l, e, u); r < e) return r;
+
+            s = MX::op(u, p[e - 1]);
+            ++b;
+        }
+
+        const i32 c = f.max_right([&](const X &x) -> bool { return g(MX::op(s, x)); }, b);
+        if (c * B >= n) return n;
+
+        s = MX::op(s, f.prod(b, c));
+        return in_block(c * B, std::min(n, (c + 1) * B), s);
+    }
+
+    template <typename F>
+    i32 min_left(F g, i32 r) const {
+        assert(0 <= r && r <= n && g(MX::unit()));
+        if (r == 0) return 0;
+
+        // First i in [lo, hi] with g(prod(i, block end) s), where v is the product of the block
+        const auto in_block = [&](i32 lo, i32 hi, const X &v, const X &s) -> i32 {
+            while (lo < hi) {
+                const i32 mid = (lo + hi) / 2;
+                const X w = mid % B == 0 ? v : MX::op(MX::inv(p[mid - 1]), v);
+                if (g(MX::op(w, s)))
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+
+            return lo;
+        };
+
+        i32 b = r / B;
+        X s = MX::unit();
+        if (r % B != 0) {
+            if (const i32 l = in_block(b * B, r, p[r - 1], MX::unit()); l > b * B) return l;
+
+            s = p[r - 1];
+        }
+
+        const i32 c = f.min_left([&](const X &x) -> bool { return g(MX::op(x, s)); }, b);
+        if (c == 0) return 0;
+
+        s = MX::op(f.prod(c, b), s);
+        return in_block((c - 1) * B + 1, c * B, p[c * B - 1], s);
+    }
+
+    i32 kth(X k, i32 l) const {
+        return max_right([&k](X x) -> bool { return x <= k; }, l);
+    }
+
+private:
+    // Product of the elements from the start of the block of r to r exclusive
+    X local(i32 r) const {
+        return r % B == 0 ? MX::unit() : p[r - 1];
+    }
+};
+
+#endif // LIB_BLOCKED_FENWICK_TREE_HPP
@@ -0,0 +1,250 @@
+#ifndef LIB_COMPACT_LAZY_SEGMENT_TREE_HPP
+#define LIB_COMPACT_LAZY_SEGMENT_TREE_HPP 1
+
+#include <bit>
+#include <cassert>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <lib/algebraic_traits.hpp>
+#include <lib/bits.hpp>
+#include <lib/prelude.hpp>
+
+// lazy_segment_tree with exactly 2n nodes: leaf i is node n + i and node k has children 2k and 2k + 1
+// For n not a power of two some nodes cover leaves that are not consecutive; no range ever uses
+// them and no tag ever reaches them, so their values are just never read
+// A node at height s covers 2^s leaves, which is passed down instead of stored
+// No max_right / min_left, which need the power of two layout
+template <typename ActedMonoid>
+struct compact_lazy_segment_tree {
+    using AM = ActedMonoid;
+
+    using MX = typename AM::MX;
+    using MA = typename AM::MA;
+
+    using X = typename MX::ValueT;
+    using A = typename MA::ValueT;
+
+    i32 n, h;
+    std::vector<X> d;
+    std::vector<A> z;
+
+    compact_lazy_segment_tree() {}
+    explicit compact_lazy_segment_tree(i32 m) {
+        build(m);
+    }
+
+    explicit compact_lazy_segment_tree(const std::vector<X> &v) {
+        build(v);
+    }
+
+    template <typename F>
+    compact_lazy_segment_tree(i32 m, F f) {
+        build(m, f);
+    }
+
+    void build(i32 m) {
+        build(m, [](i32) -> X { return MX::unit(); });
+    }
+
+    void build(const std::vector<X> &v) {
+        build(static_cast<i32>(v.size()), [&](i32 i) -> X { return v[i]; });
+    }
+
+    template <typename F>
+    void build(i32 m, F f) {
+        n = m;
+        h = static_cast<i32>(std::bit_width(static_cast<u32>(n)));
+
+        d.assign(2 * n, MX::unit());
+        z.assign(n, MA::unit());
+
+        for (i32 i = 0; i < n; ++i) d[n + i] = f(i);
+        for (i32 i = n - 1; i >= 1; --i) update(i);
+    }
+
+    void set(i32 p, const X &x) {
+        assert(0 <= p && p < n);
+
+        p += n;
+        for (i32 s = h; s >= 1; --s) push(p >> s, s);
+
+        d[p] = x;
+        for (i32 s = 1; s <= h; ++s) update(p >> s);
+    }
+
+    void multiply(i32 p, const X &x) {
+        assert(0 <= p && p < n);
+
+        p += n;
+        for (i32 s = h; s >= 1; --s) push(p >> s, s);
+
+        d[p] = MX::op(d[p], x);
+        for (i32 s = 1; s <= h; ++s) update(p >> s);
+    }
+
+    X get(i32 p) {
+        assert(0 <= p && p < n);
+
+        p += n;
+        for (i32 s = h; s >= 1; --s) push(p >> s, s);
+
+        return d[p];
+    }
+
+    std::vector<X> get_all() {
+        for (i32 k = 1; k < n; ++k) push(k, height(k));
+        return {d.begin() + n, d.end()};
+    }
+
+    X prod(i32 l, i32 r) {
+        assert(0 <= l && l <= r && r <= n);
+
+        if (l == r) return MX::unit();
+
+        l += n;
+        r += n;
+        push_boundary(l);
+        push_boundary(r);
+
+        X xl = MX::unit();
+        X xr = MX::unit();
+
+        for (; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) xl = MX::op(xl, d[l++]);
+            if (r & 1) xr = MX::op(d[--r], xr);
+        }
+
+        return MX::op(xl, xr);
+    }
+
+    X prod_all() {
+        return prod(0, n);
+    }
+
+    void apply(i32 l, i32 r, const A &a) {
+        assert(0 <= l && l <= r && r <= n);
+
+        if (l == r) return;
+
+        l += n;
+        r += n;
+        push_boundary(l);
+        push_boundary(r);
+
+        apply_range(l, r, a);
+
+        update_boundary(l);
+        update_boundary(r);
+    }
+
+    // apply(l, r, a) for every (l, r, a) in qs, which must be disjoint and sorted by l
+    // The nodes above all the boundaries are listed level by level, pushed in one top-down sweep
+    // and rebuilt in one bottom-up sweep, each once however many intervals share it
+    void apply_many(std::span<const std::tuple<i32, i32, A>> qs) {
+        std::vector<i32> bs;
+        bs.reserve(2 * qs.size());
+
+        for (const auto &[l, r, a] : qs) {
+            assert(0 <= l && l <= r && r <= n);
+            assert(bs.empty() || bs.back() <= n + l);
+
+            if (l == r) continue;
+
+            bs.push_back(n + l);
+            bs.push_back(n + r);
+        }
+
+        // ks[s] are the nodes at height s that straddle a boundary: the parents of ks[s - 1] and
+        // the nodes of the boundaries that were aligned to 2^(s - 1) but are not to 2^s
+        std::vector<std::vector<i32>> ks(h + 1);
+        std::vector<i32> nw;
+        for (i32 s = 1; s <= h; ++s) {
+            nw.clear();
+
+            i32 m = 0;
+            for (const i32 x : bs) {
+                if (x >> (s - 1) & 1)
+                    nw.push_back(x >> s);
+                else
+                    bs[m++] = x;
+            }
+
+            bs.resize(m);
+
+            const auto &prv = ks[s - 1];
+            auto &cur = ks[s];
+
+            for (usize i = 0, j = 0; i < prv.size() || j < nw.size();) {
+                const bool up = j == nw.size() || (i < prv.size() && (prv[i] >> 1) < nw[j]);
+                const i32 k = up ? prv[i++] >> 1 : nw[j++];
+
+                if (cur.empty() || cur.back() != k) cur.push_back(k);
+            }
+        }
+
+        for (i32 s = h; s >= 1; --s)
+            for (const i32 k : ks[s]) push(k, s);
+
+        for (const auto &[l, r, a] : qs)
+            if (l < r) apply_range(n + l, n + r, a);
+
+        for (i32 s = 1; s <= h; ++s)
+            for (const i32 k : ks[s]) update(k);
+    }
+
+private:
+    // Height of a node that covers consecutive leaves
+    i32 height(i32 k) const {
+        const i32 s = h - 1 - static_cast<i32>(topbit(k));
+        return (k << s) >= n ? s : s + 1;
+    }
+
+    // Ancestors of the boundary before node x (a leaf) whose ranges straddle it, top-down
+    void push_boundary(i32 x) {
+        for (i32 s = h; s >= 1; --s)
+            if (((x >> s) << s) != x) push(x >> s, s);
+    }
+
+    void update_boundary(i32 x) {
+        for (i32 s = 1; s <= h; ++s)
+            if (((x >> s) << s) != x) update(x >> s);
+    }
+
+    void apply_range(i32 l, i32 r, const A &a) {
+        for (i32 s = 0; l < r; l >>= 1, r >>= 1, ++s) {
+            if (l & 1) apply_at(l++, a, s);
+            if (r & 1) apply_at(--r, a, s);
+        }
+    }
+
+    void apply_at(i32 k, const A &a, i32 s) {
+        d[k] = AM::act(d[k], a, 1 << s);
+        if (k < n) {
+            z[k] = MA::op(z[k], a);
+
+            if constexpr (has_fail_v<MX>) {
+                if (MX::failed(d[k])) {
+                    push(k, s);
+                    update(k);
+                }
+            }
+        }
+    }
+
+    void push(i32 k, i32 s) {
+        if (z[k] == MA::unit()) return;
+
+        apply_at(2 * k, z[k], s - 1);
+        apply_at(2 * k + 1, z[k], s - 1);
+
+        z[k] = MA::unit();
+    }
+
+    void update(i32 k) {
+        d[k] = MX::op(d[2 * k], d[2 * k + 1]);
+    }
+};
+
+#endif // LIB_COMPACT_LAZY_SEGMENT_TREE_HPP
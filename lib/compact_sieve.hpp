@@ -0,0 +1,112 @@
+#ifndef LIB_COMPACT_SIEVE_HPP
+#define LIB_COMPACT_SIEVE_HPP 1
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include <lib/bits.hpp>
+#include <lib/prelude.hpp>
+
+// Least prime factors of the odd numbers up to n < 2^32, two bytes each
+// lp[i] is the least prime factor of 2i + 1, or 0 if it is prime (or 1)
+struct compact_sieve {
+    // No u32 has more distinct prime factors
+    static constexpr i32 MAX_FACTORS = 9;
+
+    using factorization = std::array<std::pair<u32, i32>, MAX_FACTORS>;
+
+    u32 n;
+    std::vector<u16> lp;
+
+    compact_sieve() {}
+    explicit compact_sieve(u32 m) {
+        build(m);
+    }
+
+    // Marked block by block so that every prime only touches a cache-sized window at a time
+    void build(u32 m) {
+        n = m;
+
+        const u64 sz = u64(n) / 2 + 1;
+        lp.assign(sz, 0);
+
+        u32 r = 1;
+        while (u64(r + 1) * (r + 1) <= n) ++r;
+
+        std::vector<u32> ps;
+        std::vector<u64> nx;
+        for (u32 p = 3; p <= r; p += 2) {
+            if (lp[p / 2] != 0) continue;
+
+            // Enough to recognise the base primes, the blocked pass below rewrites everything
+            for (u64 j = u64(p) * p; j <= r; j += 2 * p)
+                if (lp[j / 2] == 0) lp[j / 2] = static_cast<u16>(p);
+
+            ps.push_back(p);
+            nx.push_back(u64(p) * p / 2);
+        }
+
+        // Larger primes go first so that the least one is written last, without a branch
+        constexpr u64 B = u64(1) << 15;
+        for (u64 lo = 0; lo < sz; lo += B) {
+            const u64 hi = std::min(sz, lo + B);
+            for (usize i = ps.size(); i-- > 0;) {
+                u64 j = nx[i];
+                for (; j < hi; j += ps[i]) lp[j] = static_cast<u16>(ps[i]);
+
+                nx[i] = j;
+            }
+        }
+    }
+
+    inline bool is_prime(u32 k) const {
+        assert(k <= n);
+
+        return k % 2 == 0 ? k == 2 : k > 1 && lp[k / 2] == 0;
+    }
+
+    inline u32 least_prime(u32 k) const {
+        assert(1 < k && k <= n);
+
+        if (k % 2 == 0) return 2;
+        return lp[k / 2] == 0 ? k : lp[k / 2];
+    }
+
+    // Writes the factorization of k to f and returns the number of distinct primes
+    i32 factorize(u32 k, factorization &f) const {
+        assert(0 < k && k <= n);
+
+        i32 c = 0;
+        if (k % 2 == 0) {
+            const i32 e = static_cast<i32>(lowbit(k));
+            f[c++] = {2, e};
+            k >>= e;
+        }
+
+        while (k != 1) {
+            const u32 p = lp[k / 2] == 0 ? k : lp[k / 2];
+
+            i32 e = 0;
+            do {
+                k /= p;
+                ++e;
+            } while (k % p == 0);
+
+            f[c++] = {p, e};
+        }
+
+        return c;
+    }
+
+    std::vector<std::pair<u32, i32>> factorize(u32 k) const {
+        factorization f;
+        const i32 c = factorize(k, f);
+
+        return {f.begin(), f.begin() + c};
+    }
+};
+
+#endif // LIB_COMPACT_SIEVE_HPP
@@ -3,8 +3,10 @@
 
 #include <algorithm>
 #include <numeric>
+#include <utility>
 #include <vector>
 
+#include <lib/parallel.hpp>
 #include <lib/prelude.hpp>
 
 template <typename T>
@@ -28,4 +30,41 @@ std::vector<i32> compress(const std::vector<T> &v) {
     return b;
 }
 
+// Same as compress on t threads, with the distinct values in increasing order put in rv
+// The (value, index) pairs are sorted in parallel and ranked from the prefix sums of the number
+// of distinct values per chunk
+template <typename T>
+std::vector<i32> parallel_compress(const std::vector<T> &v, std::vector<T> &rv, i32 t) {
+    const i32 n = static_cast<i32>(v.size());
+    t = std::clamp(t, 1, std::max(1, n >> 6));
+
+    const std::vector<i32> ch = word_chunks(n, t);
+
+    std::vector<std::pair<T, i32>> vi(n);
+    parallel_for(t, t, [&](u64 j, i32) {
+        for (i32 i = ch[j]; i < ch[j + 1]; ++i) vi[i] = {v[i], i};
+    });
+    parallel_sort(vi, t);
+
+    std::vector<i32> c(t + 1);
+    parallel_for(t, t, [&](u64 j, i32) {
+        i32 u = 0;
+        for (i32 i = ch[j]; i < ch[j + 1]; ++i) u += i == 0 || vi[i - 1].first != vi[i].first;
+        c[j + 1] = u;
+    });
+
+    std::partial_sum(c.begin(), c.end(), c.begin());
+    rv.resize(c[t]);
+
+    std::vector<i32> b(n);
+    parallel_for(t, t, [&](u64 j, i32) {
+        for (i32 i = ch[j], r = c[j] - 1; i < ch[j + 1]; ++i) {
+            if (i == 0 || vi[i - 1].first != vi[i].first) rv[++r] = vi[i].first;
+            b[vi[i].second] = r;
+        }
+    });
+
+    return b;
+}
+
 #endif // LIB_COMPRESS_HPP
@@ -0,0 +1,54 @@
+#ifndef LIB_CONVOLUTION_HPP
+#define LIB_CONVOLUTION_HPP 1
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <lib/bits.hpp>
+#include <lib/convolution_crt.hpp>
+#include <lib/convolution_karatsuba.hpp>
+#include <lib/convolution_naive.hpp>
+#include <lib/convolution_ntt.hpp>
+#include <lib/miller_rabin.hpp>
+#include <lib/prelude.hpp>
+
+template <typename Z, typename = std::void_t<>>
+struct has_static_mod : std::false_type {};
+
+template <typename Z>
+struct has_static_mod<Z, std::void_t<std::integral_constant<decltype(Z::mod()), Z::mod()>>> : std::true_type {};
+
+template <typename Z>
+constexpr bool has_static_mod_v = has_static_mod<Z>::value;
+
+// Largest power of two dividing mod - 1 if mod is a compile-time prime, 0 otherwise
+template <typename Z>
+constexpr u64 ntt_capacity() {
+    if constexpr (has_static_mod_v<Z>) {
+        constexpr u64 m = Z::mod();
+        if constexpr (m > 2 && m <= (u64(1) << 30) && miller_rabin(m)) return (m - 1) & -(m - 1);
+    }
+
+    return 0;
+}
+
+template <typename Z>
+std::vector<Z> convolution(const std::vector<Z> &a, const std::vector<Z> &b) {
+    const i32 n = static_cast<i32>(a.size());
+    const i32 m = static_cast<i32>(b.size());
+
+    if (n == 0 || m == 0) return {};
+    if (std::min(n, m) <= 60) return convolution_naive(a, b);
+
+    const u64 sz = u64(1) << topbit(2 * (n + m - 1) - 1);
+    if (sz <= ntt_capacity<Z>()) return convolution_ntt(a, b);
+
+    if constexpr (std::numeric_limits<decltype(Z::mod())>::digits <= 32)
+        if (std::min(n, m) > 400) return convolution_crt(a, b);
+
+    return convolution_karatsuba(a, b);
+}
+
+#endif // LIB_CONVOLUTION_HPP
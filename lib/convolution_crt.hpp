@@ -0,0 +1,84 @@
+#ifndef LIB_CONVOLUTION_CRT_HPP
+#define LIB_CONVOLUTION_CRT_HPP 1
+
+#include <array>
+#include <vector>
+
+#include <lib/convolution_ntt.hpp>
+#include <lib/prelude.hpp>
+#include <lib/static_montgomery_modint.hpp>
+
+struct convolution_crt_primes {
+    static constexpr u32 m1 = 754'974'721;
+    static constexpr u32 m2 = 167'772'161;
+    static constexpr u32 m3 = 469'762'049;
+
+    using Z1 = static_montgomery_modint_32<m1>;
+    using Z2 = static_montgomery_modint_32<m2>;
+    using Z3 = static_montgomery_modint_32<m3>;
+
+    template <typename Z, typename T>
+    static std::vector<Z> reduce(const std::vector<T> &a) {
+        std::vector<Z> b(a.size());
+        for (usize i = 0; i < a.size(); ++i) b[i] = a[i];
+
+        return b;
+    }
+
+    // Calls f(i, x1, x2 * m1, x3 * m1 * m2) where the sum is the exact i-th coefficient modulo m1 * m2 * m3
+    template <typename T, typename F>
+    static void run(const std::vector<T> &a, const std::vector<T> &b, F &&f) {
+        const auto c1 = convolution_ntt(reduce<Z1>(a), reduce<Z1>(b));
+        const auto c2 = convolution_ntt(reduce<Z2>(a), reduce<Z2>(b));
+        const auto c3 = convolution_ntt(reduce<Z3>(a), reduce<Z3>(b));
+
+        static const Z2 i1 = Z2(m1).inv();
+        static const Z3 i12 = (Z3(m1) * Z3(m2)).inv();
+
+        for (usize i = 0; i < c1.size(); ++i) {
+            const u32 x1 = c1[i].val();
+            const u32 x2 = ((c2[i] - Z2(x1)) * i1).val();
+            const u32 x3 = ((c3[i] - Z3(x1) - Z3(x2) * Z3(m1)) * i12).val();
+
+            f(i, x1, x2, x3);
+        }
+    }
+};
+
+// Convolution under an arbitrary (at most 32-bit) modulus using three NTT-friendly primes
+// Exact as long as n * mod^2 < 754974721 * 167772161 * 469762049 ~ 2^85
+template <typename Z>
+std::vector<Z> convolution_crt(const std::vector<Z> &a, const std::vector<Z> &b) {
+    if (a.empty() || b.empty()) return {};
+
+    using P = convolution_crt_primes;
+
+    std::vector<u32> p(a.size()), q(b.size());
+    for (usize i = 0; i < a.size(); ++i) p[i] = static_cast<u32>(a[i].val());
+    for (usize i = 0; i < b.size(); ++i) q[i] = static_cast<u32>(b[i].val());
+
+    const Z w2 = P::m1, w3 = Z(P::m1) * Z(P::m2);
+
+    std::vector<Z> c(a.size() + b.size() - 1);
+    P::run(p, q, [&](usize i, u32 x1, u32 x2, u32 x3) { c[i] = Z(x1) + Z(x2) * w2 + Z(x3) * w3; });
+
+    return c;
+}
+
+// Exact convolution of non-negative integers modulo 2^64
+// Correct as long as every coefficient is below 754974721 * 167772161 * 469762049 ~ 2^85
+inline std::vector<u64> convolution_crt_u64(const std::vector<u64> &a, const std::vector<u64> &b) {
+    if (a.empty() || b.empty()) return {};
+
+    using P = convolution_crt_primes;
+
+    constexpr u64 w2 = P::m1;
+    constexpr u64 w3 = u64(P::m1) * P::m2;
+
+    std::vector<u64> c(a.size() + b.size() - 1);
+    P::run(a, b, [&](usize i, u32 x1, u32 x2, u32 x3) { c[i] = x1 + x2 * w2 + x3 * w3; });
+
+    return c;
+}
+
+#endif // LIB_CONVOLUTION_CRT_HPP
@@ -1,16 +1,41 @@
 #ifndef LIB_CONVOLUTION_NTT_HPP
 #define LIB_CONVOLUTION_NTT_HPP 1
 
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
 #include <lib/bits.hpp>
+#include <lib/convolution_naive.hpp>
 #include <lib/ntt.hpp>
+#include <lib/prelude.hpp>
 
+// l := first k coefficients of l * r, or all of them if k < 0
 template <typename Z>
-std::vector<Z> convolution_ntt(std::vector<Z> l, std::vector<Z> r) {
-    if (l.empty() || r.empty()) return {};
+void convolution_ntt_inplace(std::vector<Z> &l, std::vector<Z> r, i32 k = -1) {
+    if (l.empty() || r.empty()) {
+        l.clear();
+        return;
+    }
 
     const i32 n = static_cast<i32>(l.size());
     const i32 m = static_cast<i32>(r.size());
-    const i32 sz = 1 << topbit(2 * (n + m - 1) - 1);
+    if (k < 0 || k > n + m - 1) k = n + m - 1;
+
+    if (n > k) l.resize(k);
+    if (m > k) r.resize(k);
+
+    const i32 p = static_cast<i32>(l.size());
+    const i32 q = static_cast<i32>(r.size());
+
+    if (std::min(p, q) <= 32) {
+        l = convolution_naive(l, r);
+        l.resize(k);
+        return;
+    }
+
+    const i32 sz = 1 << topbit(2 * (p + q - 1) - 1);
 
     l.resize(sz);
     ntt(l, false);
@@ -21,9 +46,125 @@ std::vector<Z> convolution_ntt(std::vector<Z> l, std::vector<Z> r) {
     for (i32 i = 0; i < sz; ++i) l[i] *= r[i];
 
     ntt(l, true);
-    l.resize(n + m - 1);
+    l.resize(k);
+}
+
+template <typename Z>
+std::vector<Z> convolution_ntt(std::vector<Z> l, std::vector<Z> r, i32 k = -1) {
+    convolution_ntt_inplace(l, std::move(r), k);
+    return l;
+}
+
+template <typename Z>
+std::vector<Z> square_ntt(std::vector<Z> l, i32 k = -1) {
+    if (l.empty()) return {};
+
+    const i32 n = static_cast<i32>(l.size());
+    if (k < 0 || k > 2 * n - 1) k = 2 * n - 1;
+    if (n > k) l.resize(k);
+
+    const i32 p = static_cast<i32>(l.size());
+    if (p <= 32) {
+        l = convolution_naive(l, l);
+        l.resize(k);
+        return l;
+    }
+
+    const i32 sz = 1 << topbit(2 * (2 * p - 1) - 1);
+
+    l.resize(sz);
+    ntt(l, false);
+
+    for (i32 i = 0; i < sz; ++i) l[i] *= l[i];
+
+    ntt(l, true);
+    l.resize(k);
 
     return l;
 }
 
+// Coefficients [n - 1, m) of l * r where n = |l| <= m = |r|
+// Only needs a transform of size m instead of n + m - 1
+template <typename Z>
+std::vector<Z> middle_product_ntt(std::vector<Z> l, std::vector<Z> r) {
+    const i32 n = static_cast<i32>(l.size());
+    const i32 m = static_cast<i32>(r.size());
+    assert(0 < n && n <= m);
+
+    if (n <= 32) {
+        std::vector<Z> c(m - n + 1);
+        for (i32 i = 0; i <= m - n; ++i)
+            for (i32 j = 0; j < n; ++j) c[i] += l[j] * r[i + n - 1 - j];
+
+        return c;
+    }
+
+    const i32 sz = 1 << topbit(2 * m - 1);
+
+    l.resize(sz);
+    ntt(l, false);
+
+    r.resize(sz);
+    ntt(r, false);
+
+    for (i32 i = 0; i < sz; ++i) r[i] *= l[i];
+
+    ntt(r, true);
+
+    r.erase(r.begin(), r.begin() + n - 1);
+    r.resize(m - n + 1);
+
+    return r;
+}
+
+// Keeps the transform of a fixed operand so it can be multiplied against many others
+template <typename Z>
+struct convolution_ntt_fixed {
+    i32 n, sz;
+    std::vector<Z> f;
+
+    convolution_ntt_fixed() {}
+    explicit convolution_ntt_fixed(std::vector<Z> a, i32 m) {
+        build(std::move(a), m);
+    }
+
+    // m is the maximum length of the other operand
+    void build(std::vector<Z> a, i32 m) {
+        n = static_cast<i32>(a.size());
+        assert(n > 0 && m > 0);
+
+        sz = 1 << topbit(2 * (n + m - 1) - 1);
+
+        f = std::move(a);
+        f.resize(sz);
+        ntt(f, false);
+    }
+
+    // b := b * a mod (x^sz - 1), where |b| <= sz
+    void multiply_cyclic(std::vector<Z> &b) const {
+        assert(static_cast<i32>(b.size()) <= sz);
+
+        b.resize(sz);
+        ntt(b, false);
+
+        for (i32 i = 0; i < sz; ++i) b[i] *= f[i];
+
+        ntt(b, true);
+    }
+
+    std::vector<Z> convolution(std::vector<Z> b, i32 k = -1) const {
+        if (b.empty()) return {};
+
+        const i32 m = static_cast<i32>(b.size());
+        assert(n + m - 1 <= sz);
+
+        if (k < 0 || k > n + m - 1) k = n + m - 1;
+
+        multiply_cyclic(b);
+        b.resize(k);
+
+        return b;
+    }
+};
+
 #endif // LIB_CONVOLUTION_NTT_HPP
@@ -8,6 +8,8 @@
 
 template <typename T>
 struct csr_array {
+    static constexpr u32 SERIAL_TAG = 0x41525343; // "CSRA"
+
     csr_array() {}
     csr_array(i32 p, const std::vector<std::pair<i32, T>> &d) {
         build(p, d);
@@ -71,6 +73,28 @@ struct csr_array {
         return span(arr.data() + start[u], sz[u]);
     }
 
+    // See serialize.hpp
+    template <typename Writer>
+    void save(Writer &w) const {
+        w.value(n);
+        w.value(m);
+        w.array(start);
+        w.array(sz);
+        w.array(arr);
+    }
+
+    template <typename Reader>
+    bool load(Reader &r) {
+        if (!(r.value(n) && r.value(m) && n >= 0 && m >= 0 && r.array(start) && r.array(sz) && r.array(arr))) return false;
+        if (start.size() != static_cast<usize>(n) || sz.size() != static_cast<usize>(n) || arr.size() != static_cast<usize>(m))
+            return false;
+
+        for (i32 u = 0; u < n; ++u)
+            if (start[u] < 0 || sz[u] < 0 || i64(start[u]) + sz[u] > m) return false;
+
+        return true;
+    }
+
     i32 n, m;
 
 private:
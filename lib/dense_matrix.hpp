@@ -0,0 +1,260 @@
+#ifndef LIB_DENSE_MATRIX_HPP
+#define LIB_DENSE_MATRIX_HPP 1
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <lib/prelude.hpp>
+
+template <typename T, typename = std::void_t<>>
+struct is_modint_32 : std::false_type {};
+
+template <typename T>
+struct is_modint_32<T, std::void_t<decltype(T::mod()), decltype(std::declval<T>().val())>>
+    : std::bool_constant<std::numeric_limits<decltype(T::mod())>::digits <= 32> {};
+
+template <typename T>
+constexpr bool is_modint_32_v = is_modint_32<T>::value;
+
+// Row-major matrix in a single allocation
+// Products transpose the right operand and work on B x B tiles; for 32-bit modints the
+// dot products run on raw residues in u64 and are reduced once per run of k terms
+template <typename T>
+struct dense_matrix {
+    static constexpr i32 B = 64;
+
+    i32 H, W;
+    std::vector<T> d;
+
+    dense_matrix()
+        : H(0), W(0) {}
+
+    explicit dense_matrix(i32 n) {
+        build(n, n);
+    }
+
+    dense_matrix(i32 h, i32 w) {
+        build(h, w);
+    }
+
+    explicit dense_matrix(const std::vector<std::vector<T>> &v) {
+        build(v);
+    }
+
+    template <typename F>
+    dense_matrix(i32 h, i32 w, F f) {
+        build(h, w, f);
+    }
+
+    void build(i32 h, i32 w) {
+        H = h;
+        W = w;
+        d.assign(static_cast<usize>(H) * W, T());
+    }
+
+    void build(const std::vector<std::vector<T>> &v) {
+        const i32 h = static_cast<i32>(v.size());
+        const i32 w = h ? static_cast<i32>(v[0].size()) : 0;
+
+        build(h, w, [&](i32 i, i32 j) -> T { return v[i][j]; });
+    }
+
+    template <typename F>
+    void build(i32 h, i32 w, F f) {
+        build(h, w);
+        for (i32 i = 0; i < H; ++i)
+            for (i32 j = 0; j < W; ++j) (*this)[i][j] = f(i, j);
+    }
+
+    T *operator[](i32 i) {
+        return d.data() + static_cast<usize>(i) * W;
+    }
+
+    const T *operator[](i32 i) const {
+        return d.data() + static_cast<usize>(i) * W;
+    }
+
+    static dense_matrix eye(i32 n) {
+        dense_matrix r(n);
+        for (i32 i = 0; i < n; ++i) r[i][i] = 1;
+
+        return r;
+    }
+
+    // c := a * b, c must not alias a or b
+    static void multiply(const dense_matrix &a, const dense_matrix &b, dense_matrix &c) {
+        assert(a.W == b.H);
+        assert(&c != &a && &c != &b);
+
+        if (c.H != a.H || c.W != b.W) c.build(a.H, b.W);
+
+        if constexpr (is_modint_32_v<T>)
+            multiply_modint(a, b, c);
+        else
+            multiply_generic(a, b, c);
+    }
+
+    static void multiply_generic(const dense_matrix &a, const dense_matrix &b, dense_matrix &c) {
+        const i32 n = a.H, k = a.W, m = b.W;
+
+        std::vector<T> y(static_cast<usize>(m) * k);
+        for (i32 t = 0; t < k; ++t)
+            for (i32 j = 0; j < m; ++j) y[static_cast<usize>(j) * k + t] = b[t][j];
+
+        for (i32 i0 = 0; i0 < n; i0 += B) {
+            for (i32 j0 = 0; j0 < m; j0 += B) {
+                for (i32 i = i0; i < std::min(n, i0 + B); ++i) {
+                    const T *x = a[i];
+                    for (i32 j = j0; j < std::min(m, j0 + B); ++j) {
+                        const T *z = y.data() + static_cast<usize>(j) * k;
+
+                        T s = T();
+                        for (i32 t = 0; t < k; ++t) s += x[t] * z[t];
+                        c[i][j] = s;
+                    }
+                }
+            }
+        }
+    }
+
+    static void multiply_modint(const dense_matrix &a, const dense_matrix &b, dense_matrix &c) {
+        const i32 n = a.H, k = a.W, m = b.W;
+
+        const u64 md = T::mod();
+        const u64 sq = (md - 1) * (md - 1);
+        const i32 L = sq == 0 ? k : static_cast<i32>(std::min<u64>(std::numeric_limits<u64>::max() / sq, k));
+
+        std::vector<u32> x(static_cast<usize>(n) * k), y(static_cast<usize>(m) * k);
+
+        for (i32 i = 0; i < n; ++i)
+            for (i32 t = 0; t < k; ++t) x[static_cast<usize>(i) * k + t] = static_cast<u32>(a[i][t].val());
+
+        for (i32 t = 0; t < k; ++t)
+            for (i32 j = 0; j < m; ++j) y[static_cast<usize>(j) * k + t] = static_cast<u32>(b[t][j].val());
+
+        for (i32 i0 = 0; i0 < n; i0 += B) {
+            for (i32 j0 = 0; j0 < m; j0 += B) {
+                for (i32 i = i0; i < std::min(n, i0 + B); ++i) {
+                    const u32 *p = x.data() + static_cast<usize>(i) * k;
+
+                    i32 j = j0;
+                    for (; j + 4 <= std::min(m, j0 + B); j += 4) {
+                        const u32 *q0 = y.data() + static_cast<usize>(j) * k;
+                        const u32 *q1 = q0 + k, *q2 = q1 + k, *q3 = q2 + k;
+
+                        u64 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+                        for (i32 t0 = 0; t0 < k; t0 += L) {
+                            u64 a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+                            for (i32 t = t0; t < std::min(k, t0 + L); ++t) {
+                                const u64 v = p[t];
+                                a0 += v * q0[t];
+                                a1 += v * q1[t];
+                                a2 += v * q2[t];
+                                a3 += v * q3[t];
+                            }
+
+                            s0 += a0 % md;
+                            s1 += a1 % md;
+                            s2 += a2 % md;
+                            s3 += a3 % md;
+                        }
+
+                        c[i][j] = T(s0 % md);
+                        c[i][j + 1] = T(s1 % md);
+                        c[i][j + 2] = T(s2 % md);
+                        c[i][j + 3] = T(s3 % md);
+                    }
+
+                    for (; j < std::min(m, j0 + B); ++j) {
+                        const u32 *q = y.data() + static_cast<usize>(j) * k;
+
+                        u64 s = 0;
+                        for (i32 t0 = 0; t0 < k; t0 += L) {
+                            u64 acc = 0;
+                            for (i32 t = t0; t < std::min(k, t0 + L); ++t) acc += static_cast<u64>(p[t]) * q[t];
+                            s += acc % md;
+                        }
+
+                        c[i][j] = T(s % md);
+                    }
+                }
+            }
+        }
+    }
+
+    dense_matrix operator*(const dense_matrix &b) const {
+        dense_matrix c;
+        multiply(*this, b, c);
+
+        return c;
+    }
+
+    dense_matrix &operator*=(const dense_matrix &b) {
+        return *this = *this * b;
+    }
+
+    dense_matrix &operator+=(const dense_matrix &b) {
+        assert(H == b.H && W == b.W);
+        for (usize i = 0; i < d.size(); ++i) d[i] += b.d[i];
+
+        return *this;
+    }
+
+    dense_matrix &operator-=(const dense_matrix &b) {
+        assert(H == b.H && W == b.W);
+        for (usize i = 0; i < d.size(); ++i) d[i] -= b.d[i];
+
+        return *this;
+    }
+
+    dense_matrix operator+(const dense_matrix &b) const {
+        return dense_matrix(*this) += b;
+    }
+
+    dense_matrix operator-(const dense_matrix &b) const {
+        return dense_matrix(*this) -= b;
+    }
+
+    friend bool operator==(const dense_matrix &a, const dense_matrix &b) {
+        return a.H == b.H && a.W == b.W && a.d == b.d;
+    }
+
+    // Only three matrices are alive during the whole exponentiation
+    dense_matrix pow(u64 e) const {
+        assert(H == W);
+
+        dense_matrix r = eye(H), a = *this, t(H);
+        for (; e != 0; e >>= 1) {
+            if (e & 1) {
+                multiply(r, a, t);
+                std::swap(r, t);
+            }
+
+            if (e > 1) {
+                multiply(a, a, t);
+                std::swap(a, t);
+            }
+        }
+
+        return r;
+    }
+
+    friend std::istream &operator>>(std::istream &is, dense_matrix &a) {
+        for (auto &&e : a.d) is >> e;
+        return is;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const dense_matrix &a) {
+        for (i32 i = 0; i < a.H; ++i)
+            for (i32 j = 0; j < a.W; ++j) os << a[i][j] << (j + 1 == a.W ? '\n' : ' ');
+
+        return os;
+    }
+};
+
+#endif // LIB_DENSE_MATRIX_HPP
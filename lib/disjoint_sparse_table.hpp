@@ -1,20 +1,29 @@
 #ifndef LIB_DISJOINT_SPARSE_TABLE_HPP
 #define LIB_DISJOINT_SPARSE_TABLE_HPP 1
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
 #include <vector>
 
 #include <lib/algebraic_traits.hpp>
+#include <lib/aligned_allocator.hpp>
 #include <lib/bits.hpp>
 #include <lib/prelude.hpp>
 
+// Level k holds, around every multiple j of 2^k, the products of [p, j) for p in [j - 2^k, j)
+// and of [j, p] for p in [j, j + 2^k)
+// All levels share one allocation, each starting on a cache line s elements after the previous
 template <typename Monoid, is_monoid_t<Monoid> * = nullptr>
 struct disjoint_sparse_table {
     using MX = Monoid;
     using X = typename MX::ValueT;
 
+    static constexpr usize L = 64 / std::gcd<usize>(64, sizeof(X));
+
     i32 n, log;
-    std::vector<std::vector<X>> d;
+    usize s;
+    std::vector<X, aligned_allocator<X>> d;
 
     disjoint_sparse_table() {}
     explicit disjoint_sparse_table(i32 m) {
@@ -30,6 +39,10 @@ struct disjoint_sparse_table {
         build(m, f);
     }
 
+    void build(i32 m) {
+        build(m, [](i32) -> X { return MX::unit(); });
+    }
+
     void build(const std::vector<X> &v) {
         build(static_cast<i32>(v.size()), [&](i32 i) -> X { return v[i]; });
     }
@@ -40,22 +53,29 @@ struct disjoint_sparse_table {
 
         log = 1;
         while ((1 << log) < n) ++log;
-        d.resize(log);
 
-        d[0].resize(n);
-        for (i32 i = 0; i < n; ++i) d[0][i] = f(i);
+        s = (static_cast<usize>(n) + L - 1) / L * L;
+        d.assign(s * log, MX::unit());
 
+        const X *a = d.data();
+        for (i32 i = 0; i < n; ++i) d[i] = f(i);
+
+        // One pass per level, every entry written once from the level 0 values
         for (i32 i = 1; i < log; ++i) {
-            auto &v = d[i];
-            v = d[0];
+            X *v = d.data() + s * i;
 
             const i32 k = 1 << i;
             for (i32 j = k; j <= n; j += 2 * k) {
                 const i32 l = j - k;
                 const i32 r = std::min(n, j + k);
 
-                for (i32 p = j - 1; p >= l + 1; --p) v[p - 1] = MX::op(v[p - 1], v[p]);
-                for (i32 p = j; p < r - 1; ++p) v[p + 1] = MX::op(v[p], v[p + 1]);
+                v[j - 1] = a[j - 1];
+                for (i32 p = j - 1; p > l; --p) v[p - 1] = MX::op(a[p - 1], v[p]);
+
+                if (j == r) continue;
+
+                v[j] = a[j];
+                for (i32 p = j; p < r - 1; ++p) v[p + 1] = MX::op(v[p], a[p + 1]);
             }
         }
     }
@@ -63,7 +83,7 @@ struct disjoint_sparse_table {
     X get(i32 p) const {
         assert(0 <= p && p < n);
 
-        return prod(p, p + 1);
+        return d[p];
     }
 
     X prod(i32 l, i32 r) const {
@@ -71,10 +91,10 @@ struct disjoint_sparse_table {
 
         --r;
         if (l == r + 1) return MX::unit();
-        if (l == r) return d[0][l];
+        if (l == r) return d[l];
 
-        const i32 k = topbit(l ^ r);
-        return MX::op(d[k][l], d[k][r]);
+        const X *v = d.data() + s * topbit(l ^ r);
+        return MX::op(v[l], v[r]);
     }
 };
 
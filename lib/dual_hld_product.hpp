@@ -51,10 +51,7 @@ struct dual_hld_product {
     }
 
     void apply_path(i32 u, i32 v, const A &a) {
-        for (const auto &[s, t] : h.decompose(u, v)) {
-            const auto &[x, y] = std::minmax(h.tin[s], h.tin[t]);
-            st.apply(x, y + 1, a);
-        }
+        for (const auto &[l, r, up] : h.path(u, v)) st.apply(l, r, a);
     }
 
     void apply_subtree(i32 u, const A &a) {
@@ -0,0 +1,431 @@
+#ifndef LIB_FACTORIZE_MANY_HPP
+#define LIB_FACTORIZE_MANY_HPP 1
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <lib/bits.hpp>
+#include <lib/prelude.hpp>
+#include <lib/random.hpp>
+
+// Montgomery form for any odd 64-bit modulus, held by value so that every lane has its own
+struct montgomery_u64 {
+    u64 n, ni, r1, r2;
+
+    montgomery_u64() {}
+    explicit montgomery_u64(u64 m) {
+        build(m);
+    }
+
+    void build(u64 m) {
+        n = m;
+
+        ni = n;
+        for (i32 i = 0; i < 5; ++i) ni *= 2 - n * ni;
+
+        r1 = static_cast<u64>((u128(1) << 64) % n);
+        r2 = static_cast<u64>(u128(r1) * r1 % n);
+    }
+
+    // Values stay in [0, n); the corrections are masks rather than branches, which the lanes
+    // would mispredict half of the time
+    u64 mul(u64 a, u64 b) const {
+        const u128 t = u128(a) * b;
+        const u64 h = static_cast<u64>(t >> 64);
+        const u64 l = static_cast<u64>((u128(static_cast<u64>(t) * ni) * n) >> 64);
+
+        return h - l + (n & -u64(h < l));
+    }
+
+    u64 add(u64 a, u64 b) const {
+        const u64 s = a - (n - b);
+        return s + (n & -u64(a < n - b));
+    }
+
+    static u64 dist(u64 a, u64 b) {
+        const u64 d = a - b, m = -u64(a < b);
+        return (d ^ m) - m;
+    }
+
+    u64 to(u64 a) const {
+        return mul(a % n, r2);
+    }
+
+    u64 from(u64 a) const {
+        return mul(a, 1);
+    }
+};
+
+// Montgomery form for odd moduli below 2^62 with lazy reduction, as in pollard_rho: values stay in
+// [0, 2n) and are never corrected, so they are only good for a gcd with n, which is all that
+// Pollard-Brent takes from them
+struct montgomery_u62 {
+    u64 n, ni, r1, r2;
+
+    montgomery_u62() {}
+    explicit montgomery_u62(u64 m) {
+        build(m);
+    }
+
+    void build(u64 m) {
+        n = m;
+
+        u64 p = n;
+        for (i32 i = 0; i < 5; ++i) p *= 2 - n * p;
+        ni = -p;
+
+        r1 = static_cast<u64>((u128(1) << 64) % n);
+        r2 = static_cast<u64>(u128(r1) * r1 % n);
+    }
+
+    u64 mul(u64 a, u64 b) const {
+        const u128 t = u128(a) * b;
+        return static_cast<u64>((t + u128(static_cast<u64>(t) * ni) * n) >> 64);
+    }
+
+    u64 add(u64 a, u64 b) const {
+        const u64 s = a + b - 2 * n;
+        return s + (2 * n & -(s >> 63));
+    }
+
+    static u64 dist(u64 a, u64 b) {
+        return montgomery_u64::dist(a, b);
+    }
+
+    u64 to(u64 a) const {
+        return mul(a % n, r2);
+    }
+};
+
+// Miller-Rabin and Pollard-Brent over K numbers at once: the lanes are independent dependency
+// chains of 64-bit multiplications, so interleaving them hides the multiply latency
+template <i32 K = 4>
+struct factorize_lanes {
+    static constexpr std::array<u64, 7> BASES = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+    // res[l] := whether odd n[l] > 2 is prime
+    static void miller_rabin(const std::array<montgomery_u64, K> &ms, std::array<bool, K> &res) {
+        std::array<u64, K> d, one, neg;
+        std::array<i32, K> s;
+        i32 hb = 0;
+
+        for (i32 l = 0; l < K; ++l) {
+            const u64 n = ms[l].n;
+
+            s[l] = static_cast<i32>(lowbit(n - 1));
+            d[l] = (n - 1) >> s[l];
+            one[l] = ms[l].r1;
+            neg[l] = n - ms[l].r1;
+            res[l] = true;
+            hb = std::max(hb, static_cast<i32>(topbit(d[l])));
+        }
+
+        for (const u64 b : BASES) {
+            std::array<u64, K> x, y;
+            std::array<bool, K> skip;
+
+            for (i32 l = 0; l < K; ++l) {
+                skip[l] = !res[l] || b % ms[l].n == 0;
+                x[l] = ms[l].to(b);
+                y[l] = one[l];
+            }
+
+            // Square-and-multiply from the top bit, with the lanes in lockstep
+            for (i32 i = hb; i >= 0; --i) {
+                for (i32 l = 0; l < K; ++l) {
+                    y[l] = ms[l].mul(y[l], y[l]);
+
+                    const u64 z = ms[l].mul(y[l], x[l]);
+                    y[l] = (d[l] >> i) & 1 ? z : y[l];
+                }
+            }
+
+            for (i32 l = 0; l < K; ++l) {
+                if (skip[l] || y[l] == one[l] || y[l] == neg[l]) continue;
+
+                bool ok = false;
+                for (i32 i = 1; i < s[l] && !ok; ++i) {
+                    y[l] = ms[l].mul(y[l], y[l]);
+                    ok = y[l] == neg[l];
+                }
+
+                res[l] = ok;
+            }
+        }
+    }
+
+    // One round of a lane, two multiplications either way: with Acc one step y := y^2 + c and
+    // |x - y| multiplied into q, without it two steps of walking ahead
+    template <bool Acc, typename Mont>
+    static void step(const Mont &mt, u64 c, u64 x, u64 &y, u64 &q) {
+        y = mt.add(mt.mul(y, y), c);
+        if constexpr (Acc)
+            q = mt.mul(q, Mont::dist(x, y));
+        else
+            y = mt.add(mt.mul(y, y), c);
+    }
+
+    // M rounds of every lane, lane l accumulating iff bit l of A is set; the lanes are unrolled
+    // into locals so that their chains stay in registers and interleave
+    template <typename Mont, i32 M, u32 A, usize... Ls>
+    static void walk(const std::array<Mont, K> &ms, const std::array<u64, K> &c, const std::array<u64, K> &x,
+                     std::array<u64, K> &y, std::array<u64, K> &q, std::index_sequence<Ls...>) {
+        std::array<u64, K> a = y, b = q;
+
+        for (i32 i = 0; i < M; ++i) (step<(A >> Ls & 1) != 0>(ms[Ls], c[Ls], x[Ls], a[Ls], b[Ls]), ...);
+
+        y = a;
+        q = b;
+    }
+
+    // walk for every mask A, so that choosing one costs an indirect call per M rounds rather than
+    // a select per lane and round
+    template <typename Mont, i32 M, u32... As>
+    static constexpr auto walks(std::integer_sequence<u32, As...>) {
+        using W = void (*)(const std::array<Mont, K> &, const std::array<u64, K> &, const std::array<u64, K> &,
+                           std::array<u64, K> &, std::array<u64, K> &, std::make_index_sequence<K>);
+        return std::array<W, sizeof...(As)>{&walk<Mont, M, As>...};
+    }
+
+    // A nontrivial factor of every odd composite n, Brent's cycle finding with the
+    // differences multiplied together and one gcd every M steps; a lane walking ahead takes two
+    // steps per round, so every lane costs the same per round whatever it is doing
+    // Mont is montgomery_u62 when every n is below 2^62, montgomery_u64 otherwise
+    template <typename Mont = montgomery_u64>
+    static void pollard_brent(std::span<const u64> ns, std::span<u64> res) {
+        constexpr i32 M = 128;
+
+        std::array<Mont, K> ms;
+        std::array<u64, K> c, x, y, ys, q;
+        std::array<i64, K> r, cnt;
+        std::array<bool, K> acc;
+        std::array<i64, K> id;
+
+        usize nxt = 0;
+        i32 active = 0;
+
+        const auto start = [&](i32 l, i64 i) {
+            id[l] = i;
+            if (i < 0) {
+                // An idle lane keeps spinning on 3 to keep the loop branch-free
+                ms[l].build(3);
+            } else {
+                ms[l].build(ns[i]);
+            }
+
+            c[l] = ms[l].to(MT() % ms[l].n);
+            y[l] = x[l] = ms[l].to(MT() % ms[l].n);
+            q[l] = ms[l].r1;
+            r[l] = 2 * M;
+            cnt[l] = 0;
+            acc[l] = false;
+        };
+
+        for (i32 l = 0; l < K; ++l) {
+            if (nxt < ns.size()) {
+                start(l, static_cast<i64>(nxt++));
+                ++active;
+            } else {
+                start(l, -1);
+            }
+        }
+
+        static constexpr auto ws = walks<Mont, M>(std::make_integer_sequence<u32, 1 << K>{});
+
+        while (active > 0) {
+            u32 a = 0;
+            for (i32 l = 0; l < K; ++l) a |= static_cast<u32>(acc[l]) << l;
+
+            ys = y;
+            ws[a](ms, c, x, y, q, std::make_index_sequence<K>{});
+
+            for (i32 l = 0; l < K; ++l) {
+                if (id[l] < 0) continue;
+
+                const u64 n = ms[l].n;
+
+                if (!acc[l]) {
+                    // Walking y ahead by r steps before comparing against x again
+                    cnt[l] += 2 * M;
+                    if (cnt[l] == r[l]) {
+                        acc[l] = true;
+                        cnt[l] = 0;
+                    }
+
+                    continue;
+                }
+
+                cnt[l] += M;
+                u64 g = std::gcd(q[l], n);
+                if (g == n) {
+                    // Too many steps at once, redo the last M one by one
+                    u64 z = ys[l];
+                    do {
+                        z = ms[l].add(ms[l].mul(z, z), c[l]);
+                        g = std::gcd(Mont::dist(x[l], z), n);
+                    } while (g == 1);
+                }
+
+                if (g == 1) {
+                    if (cnt[l] == r[l]) {
+                        x[l] = y[l];
+                        r[l] *= 2;
+                        cnt[l] = 0;
+                        acc[l] = false;
+                    }
+
+                    continue;
+                }
+
+                if (g == n) {
+                    start(l, id[l]);
+                    continue;
+                }
+
+                res[id[l]] = g;
+                if (nxt < ns.size()) {
+                    start(l, static_cast<i64>(nxt++));
+                } else {
+                    start(l, -1);
+                    --active;
+                }
+            }
+        }
+    }
+};
+
+// Factorization of every number in ns, each as (prime, exponent) pairs in increasing order
+// Small primes are divided out with multiplications by their inverses mod 2^64, what remains is
+// tested and split in lanes; cofactors go around again until every one of them is prime
+inline std::vector<std::vector<std::pair<u64, i32>>> factorize_many(std::span<const u64> ns) {
+    constexpr i32 K = 4;
+    constexpr u64 P = 1 << 9;
+
+    // Odd primes below P with p^-1 mod 2^64 and floor((2^64 - 1) / p): p | n iff n p^-1 <= that
+    static const auto small = []() {
+        std::vector<std::array<u64, 3>> t;
+        for (u64 p = 3; p < P; p += 2) {
+            bool pr = true;
+            for (u64 d = 3; d * d <= p; d += 2) pr &= p % d != 0;
+            if (!pr) continue;
+
+            u64 ip = p;
+            for (i32 i = 0; i < 5; ++i) ip *= 2 - p * ip;
+
+            t.push_back({p, ip, ~u64(0) / p});
+        }
+
+        return t;
+    }();
+
+    const usize N = ns.size();
+    std::vector<std::vector<std::pair<u64, i32>>> fs(N);
+
+    std::vector<u64> vs;
+    std::vector<usize> owner;
+    std::vector<u64> primes;
+    std::vector<usize> powner;
+
+    for (usize i = 0; i < N; ++i) {
+        u64 n = ns[i];
+        if (n <= 1) continue;
+
+        const i32 e = static_cast<i32>(lowbit(n));
+        if (e > 0) {
+            fs[i].emplace_back(2, e);
+            n >>= e;
+        }
+
+        for (const auto &[p, ip, lim] : small) {
+            if (p * p > n) break;
+            if (n * ip > lim) continue;
+
+            i32 c = 0;
+            do {
+                n *= ip;
+                ++c;
+            } while (n * ip <= lim);
+
+            fs[i].emplace_back(p, c);
+        }
+
+        if (n == 1) continue;
+
+        // No factor below P is left, so anything below P^2 is prime
+        if (n < P * P) {
+            primes.push_back(n);
+            powner.push_back(i);
+        } else {
+            vs.push_back(n);
+            owner.push_back(i);
+        }
+    }
+
+    while (!vs.empty()) {
+        std::vector<u64> cs;
+        std::vector<usize> cowner;
+
+        for (usize i = 0; i < vs.size(); i += K) {
+            std::array<montgomery_u64, K> ms;
+            std::array<bool, K> res;
+
+            for (i32 l = 0; l < K; ++l) ms[l].build(i + l < vs.size() ? vs[i + l] : 3);
+            factorize_lanes<K>::miller_rabin(ms, res);
+
+            for (i32 l = 0; l < K && i + l < vs.size(); ++l) {
+                if (res[l]) {
+                    primes.push_back(vs[i + l]);
+                    powner.push_back(owner[i + l]);
+                } else {
+                    cs.push_back(vs[i + l]);
+                    cowner.push_back(owner[i + l]);
+                }
+            }
+        }
+
+        // Nearly every cofactor fits the lazy form; the few from 2^62 up go first, in full form
+        std::vector<usize> ord(cs.size());
+        std::iota(ord.begin(), ord.end(), 0);
+        const auto mid = std::stable_partition(ord.begin(), ord.end(), [&](usize i) { return cs[i] >> 62 != 0; });
+        const usize h = static_cast<usize>(mid - ord.begin());
+
+        std::vector<u64> xs(cs.size()), ds(cs.size());
+        for (usize i = 0; i < cs.size(); ++i) xs[i] = cs[ord[i]];
+
+        const std::span<const u64> sx(xs);
+        const std::span<u64> sd(ds);
+        factorize_lanes<K>::template pollard_brent<montgomery_u64>(sx.first(h), sd.first(h));
+        factorize_lanes<K>::template pollard_brent<montgomery_u62>(sx.subspan(h), sd.subspan(h));
+
+        vs.clear();
+        owner.clear();
+        for (usize i = 0; i < cs.size(); ++i) {
+            for (const u64 d : {ds[i], xs[i] / ds[i]}) {
+                vs.push_back(d);
+                owner.push_back(cowner[ord[i]]);
+            }
+        }
+    }
+
+    // Grouping the large primes by owner
+    std::vector<usize> ord(primes.size());
+    std::iota(ord.begin(), ord.end(), 0);
+    std::sort(ord.begin(), ord.end(),
+              [&](usize a, usize b) { return std::pair(powner[a], primes[a]) < std::pair(powner[b], primes[b]); });
+
+    for (const usize j : ord) {
+        auto &f = fs[powner[j]];
+        if (!f.empty() && f.back().first == primes[j])
+            ++f.back().second;
+        else
+            f.emplace_back(primes[j], 1);
+    }
+
+    return fs;
+}
+
+#endif // LIB_FACTORIZE_MANY_HPP
@@ -2,9 +2,11 @@
 #define LIB_FENWICK_TREE_HPP 1
 
 #include <cassert>
+#include <span>
 #include <vector>
 
 #include <lib/algebraic_traits.hpp>
+#include <lib/batch_operation.hpp>
 #include <lib/bits.hpp>
 #include <lib/prelude.hpp>
 
@@ -98,11 +100,55 @@ struct fenwick_tree {
         multiply(p, MX::op(MX::inv(get(p)), x));
     }
 
+    // Runs ops in order and returns the results of the prods
+    // A long run of updates is gathered into one delta per position and pushed up in a single
+    // pass over the tree like build; a set reads the tree from before the run, times the deltas
+    // gathered so far
+    std::vector<X> batch(std::span<const batch_operation<X>> ops) {
+        std::vector<X> res;
+        std::vector<X> a;
+
+        for (usize s = 0, e = 0; s < ops.size(); s = e) {
+            while (e < ops.size() && ops[e].type != batch_op::prod) ++e;
+
+            if (n == 0 || static_cast<i64>(e - s) * static_cast<i64>(topbit(n) + 1) < n) {
+                for (usize i = s; i < e; ++i) {
+                    if (ops[i].type == batch_op::set)
+                        set(ops[i].l, ops[i].x);
+                    else
+                        multiply(ops[i].l, ops[i].x);
+                }
+            } else {
+                a.assign(n, MX::unit());
+                for (usize i = s; i < e; ++i) {
+                    const auto &o = ops[i];
+                    assert(0 <= o.l && o.l < n);
+
+                    a[o.l] = o.type == batch_op::set ? MX::op(MX::inv(get(o.l)), o.x) : MX::op(a[o.l], o.x);
+                }
+
+                for (i32 i = 1; i <= n; ++i) {
+                    d[i - 1] = MX::op(d[i - 1], a[i - 1]);
+
+                    const i32 j = i + (i & -i);
+                    if (j <= n) a[j - 1] = MX::op(a[i - 1], a[j - 1]);
+                }
+
+                t = prod(n);
+            }
+
+            for (; e < ops.size() && ops[e].type == batch_op::prod; ++e) res.push_back(prod(ops[e].l, ops[e].r));
+        }
+
+        return res;
+    }
+
     template <typename F>
     i32 max_right(F f, i32 l) const {
         assert(0 <= l && l <= n && f(MX::unit()));
+        if (l == n) return n;
 
-        MX s = MX::unit();
+        X s = MX::unit();
         i32 i = l;
 
         i32 k;
@@ -115,7 +161,7 @@ struct fenwick_tree {
 
             k = lowbit(i) - 1;
             if (i + (1 << k) > n) break;
-            if (const MX u = MX::op(s, d[i + (1 << k) - 1]); !f(u)) break;
+            if (const X u = MX::op(s, d[i + (1 << k) - 1]); !f(u)) break;
 
             s = MX::op(s, MX::inv(d[i - 1]));
             i -= i & -i;
@@ -123,7 +169,7 @@ struct fenwick_tree {
 
         while (k--) {
             if (i + (1 << k) - 1 < n) {
-                if (const MX u = MX::op(s, d[i + (1 << k) - 1]); f(u)) {
+                if (const X u = MX::op(s, d[i + (1 << k) - 1]); f(u)) {
                     i += 1 << k;
                     s = u;
                 }
@@ -136,8 +182,9 @@ struct fenwick_tree {
     template <typename F>
     i32 min_left(F f, i32 r) const {
         assert(0 <= r && r <= n && f(MX::unit()));
+        if (r == 0) return 0;
 
-        MX s = MX::unit();
+        X s = MX::unit();
         i32 i = r;
 
         i32 k = 0;
@@ -153,11 +200,13 @@ struct fenwick_tree {
         }
 
         while (k--) {
-            if (const MX u = MX::op(s, MX::inv(d[i + (1 << k) - 1])); !f(u)) {
+            if (const X u = MX::op(s, MX::inv(d[i + (1 << k) - 1])); !f(u)) {
                 i += 1 << k;
                 s = u;
             }
         }
+
+        return i + 1;
     }
 
     i32 kth(X k, i32 l) const {
@@ -0,0 +1,301 @@
+#ifndef LIB_FPS_HPP
+#define LIB_FPS_HPP 1
+
+#include <algorithm>
+#include <cassert>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <lib/convolution_ntt.hpp>
+#include <lib/ntt.hpp>
+#include <lib/prelude.hpp>
+#include <lib/sqrt.hpp>
+
+// All routines take a series f and return its first n coefficients
+// Z must be an NTT-friendly prime field
+
+template <typename Z>
+std::vector<Z> fps_inverses(i32 n) {
+    std::vector<Z> iv(std::max(n, 2));
+
+    iv[1] = 1;
+    for (i32 i = 2; i < n; ++i) iv[i] = -iv[Z::mod() % i] * Z(Z::mod() / i);
+
+    return iv;
+}
+
+template <typename Z>
+std::vector<Z> fps_derivative(const std::vector<Z> &f) {
+    const i32 n = static_cast<i32>(f.size());
+    if (n <= 1) return {};
+
+    std::vector<Z> g(n - 1);
+    for (i32 i = 1; i < n; ++i) g[i - 1] = f[i] * i;
+
+    return g;
+}
+
+template <typename Z>
+std::vector<Z> fps_integral(const std::vector<Z> &f) {
+    const i32 n = static_cast<i32>(f.size());
+    const auto iv = fps_inverses<Z>(n + 1);
+
+    std::vector<Z> g(n + 1);
+    for (i32 i = 0; i < n; ++i) g[i + 1] = f[i] * iv[i + 1];
+
+    return g;
+}
+
+template <typename Z>
+std::vector<Z> fps_inv(const std::vector<Z> &f, i32 n) {
+    assert(!f.empty() && f[0] != 0);
+
+    std::vector<Z> g{f[0].inv()};
+    g.reserve(n);
+
+    // f * g = 1 + x^k e, so only the upper half of both cyclic products is needed
+    std::vector<Z> a, b;
+    for (i32 k = 1; k < n; k <<= 1) {
+        const i32 sz = 2 * k;
+
+        a.assign(f.begin(), f.begin() + std::min<i32>(sz, static_cast<i32>(f.size())));
+        a.resize(sz);
+        ntt(a, false);
+
+        b = g;
+        b.resize(sz);
+        ntt(b, false);
+
+        for (i32 i = 0; i < sz; ++i) a[i] *= b[i];
+        ntt(a, true);
+
+        std::fill(a.begin(), a.begin() + k, Z());
+        ntt(a, false);
+
+        for (i32 i = 0; i < sz; ++i) a[i] *= b[i];
+        ntt(a, true);
+
+        g.resize(sz);
+        for (i32 i = k; i < sz; ++i) g[i] = -a[i];
+    }
+
+    g.resize(n);
+    return g;
+}
+
+template <typename Z>
+std::vector<Z> fps_log(const std::vector<Z> &f, i32 n) {
+    assert(!f.empty() && f[0] == 1);
+    if (n == 0) return {};
+
+    std::vector<Z> g(f.begin(), f.begin() + std::min<i32>(n, static_cast<i32>(f.size())));
+
+    auto h = convolution_ntt(fps_derivative(g), fps_inv(g, n), n - 1);
+    h = fps_integral(h);
+    h.resize(n);
+
+    return h;
+}
+
+template <typename Z>
+std::vector<Z> fps_exp(const std::vector<Z> &f, i32 n) {
+    assert(f.empty() || f[0] == 0);
+
+    const auto coef = [&](i32 i) -> Z { return i < static_cast<i32>(f.size()) ? f[i] : Z(); };
+
+    // g = exp f mod x^m and h = 1 / g mod x^(m / 2), with th the size m transform of h
+    // Every round extends h by one Newton step, then g := g (1 + f - log g) using h for the
+    // division by g; the size 2m transform of g serves both, its first half being the size m one
+    std::vector<Z> g{1, coef(1)}, h{1}, th{1}, tg, a;
+    th.resize(2);
+    ntt(th, false);
+
+    for (i32 m = 2; m < n; m <<= 1) {
+        tg = g;
+        tg.resize(2 * m);
+        ntt(tg, false);
+
+        // h := h (2 - g h), g h = 1 + x^(m / 2) e
+        a.resize(m);
+        for (i32 i = 0; i < m; ++i) a[i] = tg[i] * th[i];
+        ntt(a, true);
+
+        std::fill(a.begin(), a.begin() + m / 2, Z());
+        ntt(a, false);
+
+        for (i32 i = 0; i < m; ++i) a[i] *= -th[i];
+        ntt(a, true);
+
+        h.insert(h.end(), a.begin() + m / 2, a.end());
+        th = h;
+        th.resize(2 * m);
+        ntt(th, false);
+
+        // g f' - g' vanishes below x^(m - 1), so its cyclic product of size m holds the
+        // coefficients from x^(m - 1) on, shifted down
+        a.assign(m, Z());
+        for (i32 i = 1; i < m; ++i) a[i - 1] = coef(i) * i;
+        ntt(a, false);
+
+        for (i32 i = 0; i < m; ++i) a[i] *= tg[i];
+        ntt(a, true);
+
+        for (i32 i = 1; i < m; ++i) a[i - 1] -= g[i] * i;
+
+        a.resize(2 * m);
+        for (i32 i = 0; i + 1 < m; ++i) {
+            a[m + i] = a[i];
+            a[i] = Z();
+        }
+
+        // f - log g from x^m on, as the integral of f' - g' / g plus the terms of f not in f' above
+        ntt(a, false);
+        for (i32 i = 0; i < 2 * m; ++i) a[i] *= th[i];
+        ntt(a, true);
+
+        a.pop_back();
+        a = fps_integral(a);
+        for (i32 i = 0; i < m; ++i) {
+            a[i] = Z();
+            a[m + i] += coef(m + i);
+        }
+
+        ntt(a, false);
+        for (i32 i = 0; i < 2 * m; ++i) a[i] *= tg[i];
+        ntt(a, true);
+
+        g.insert(g.end(), a.begin() + m, a.end());
+    }
+
+    g.resize(n);
+    return g;
+}
+
+template <typename Z>
+std::vector<Z> fps_pow(const std::vector<Z> &f, u64 k, i32 n) {
+    if (n == 0) return {};
+
+    std::vector<Z> g(n);
+    if (k == 0) {
+        g[0] = 1;
+        return g;
+    }
+
+    const i32 m = static_cast<i32>(f.size());
+
+    i32 z = 0;
+    while (z < m && f[z] == 0) ++z;
+    if (z == m || (z > 0 && k >= u64((n + z - 1) / z))) return g;
+
+    const i32 s = static_cast<i32>(z * k);
+    const Z c = f[z], ic = c.inv();
+
+    std::vector<Z> h(f.begin() + z, f.begin() + std::min(m, z + n - s));
+    for (auto &&e : h) e *= ic;
+
+    h = fps_log(h, n - s);
+    for (auto &&e : h) e *= k;
+    h = fps_exp(h, n - s);
+
+    const Z ck = c.pow(k);
+    for (i32 i = 0; i < n - s; ++i) g[i + s] = h[i] * ck;
+
+    return g;
+}
+
+template <typename Z>
+std::optional<std::vector<Z>> fps_sqrt(const std::vector<Z> &f, i32 n) {
+    if (n == 0) return std::vector<Z>{};
+
+    const i32 m = static_cast<i32>(f.size());
+
+    i32 z = 0;
+    while (z < m && f[z] == 0) ++z;
+    if (z == m || z / 2 >= n) return std::vector<Z>(n);
+    if (z % 2 == 1) return std::nullopt;
+
+    const auto r = ::sqrt(f[z]);
+    if (!r.has_value()) return std::nullopt;
+
+    const i32 s = z / 2;
+    const std::vector<Z> h(f.begin() + z, f.end());
+    const Z i2 = Z(2).inv();
+
+    const auto coef = [&](i32 i) -> Z { return i < static_cast<i32>(h.size()) ? h[i] : Z(); };
+
+    // g = sqrt h mod x^k and u = 1 / g mod x^(k / 2) (mod x for k = 1), with tu the size k
+    // transform of u; every round extends u by one Newton step and then g := g + (h - g^2) / 2g,
+    // where h - g^2 vanishes below x^k so u mod x^k suffices, the transform of g serving both
+    std::vector<Z> g{*r}, u{r->inv()}, tu, tg, a;
+    for (i32 k = 1; k < n - s; k <<= 1) {
+        tg = g;
+        tg.resize(2 * k);
+        ntt(tg, false);
+
+        // u := u (2 - g u), g u = 1 + x^(k / 2) e
+        if (k > 1) {
+            a.resize(k);
+            for (i32 i = 0; i < k; ++i) a[i] = tg[i] * tu[i];
+            ntt(a, true);
+
+            std::fill(a.begin(), a.begin() + k / 2, Z());
+            ntt(a, false);
+
+            for (i32 i = 0; i < k; ++i) a[i] *= -tu[i];
+            ntt(a, true);
+
+            u.insert(u.end(), a.begin() + k / 2, a.end());
+        }
+
+        tu = u;
+        tu.resize(2 * k);
+        ntt(tu, false);
+
+        for (i32 i = 0; i < 2 * k; ++i) tg[i] *= tg[i];
+        ntt(tg, true);
+
+        a.assign(2 * k, Z());
+        for (i32 i = 0; i < k; ++i) a[i] = coef(k + i) - tg[k + i];
+        ntt(a, false);
+
+        for (i32 i = 0; i < 2 * k; ++i) a[i] *= tu[i];
+        ntt(a, true);
+
+        for (i32 i = 0; i < k; ++i) g.push_back(a[i] * i2);
+    }
+
+    std::vector<Z> res(n);
+    for (i32 i = 0; i < n - s; ++i) res[i + s] = g[i];
+
+    return res;
+}
+
+// {q, r} with a = b * q + r and deg r < deg b
+template <typename Z>
+std::pair<std::vector<Z>, std::vector<Z>> poly_divmod(std::vector<Z> a, std::vector<Z> b) {
+    while (!a.empty() && a.back() == 0) a.pop_back();
+    while (!b.empty() && b.back() == 0) b.pop_back();
+    assert(!b.empty());
+
+    const i32 n = static_cast<i32>(a.size());
+    const i32 m = static_cast<i32>(b.size());
+    if (n < m) return {{}, a};
+
+    const i32 k = n - m + 1;
+
+    std::vector<Z> ra(a.rbegin(), a.rbegin() + k), rb(b.rbegin(), b.rend());
+    auto q = convolution_ntt(std::move(ra), fps_inv(rb, k), k);
+    q.resize(k);
+    std::reverse(q.begin(), q.end());
+
+    const auto p = convolution_ntt(b, q, m - 1);
+
+    std::vector<Z> r(m - 1);
+    for (i32 i = 0; i < m - 1; ++i) r[i] = a[i] - (i < static_cast<i32>(p.size()) ? p[i] : Z());
+    while (!r.empty() && r.back() == 0) r.pop_back();
+
+    return {q, r};
+}
+
+#endif // LIB_FPS_HPP
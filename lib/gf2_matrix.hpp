@@ -0,0 +1,176 @@
+#ifndef LIB_GF2_MATRIX_HPP
+#define LIB_GF2_MATRIX_HPP 1
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <lib/bits.hpp>
+#include <lib/bitset.hpp>
+#include <lib/prelude.hpp>
+
+// n x N matrix over GF(2), every row is a bitset<N>
+template <usize N>
+struct gf2_matrix {
+    using row_type = bitset<N>;
+
+    i32 n;
+    std::vector<row_type> a;
+
+    gf2_matrix() {}
+    explicit gf2_matrix(i32 m) {
+        build(m);
+    }
+
+    void build(i32 m) {
+        n = m;
+        a.assign(n, row_type());
+    }
+
+    static gf2_matrix eye() {
+        gf2_matrix r(static_cast<i32>(N));
+        for (usize i = 0; i < N; ++i) r[i].set(i);
+
+        return r;
+    }
+
+    row_type &operator[](i32 i) {
+        return a[i];
+    }
+
+    const row_type &operator[](i32 i) const {
+        return a[i];
+    }
+
+    // Reduces to row echelon form (fully reduced if rref) and returns the pivot columns
+    // swap(i, j) and add(i, j) are replayed on anything that has to follow the row operations
+    template <typename Swap, typename Add>
+    std::vector<i32> eliminate(bool rref, Swap &&swap, Add &&add) {
+        std::vector<i32> piv;
+
+        i32 r = 0;
+        for (usize c = 0; c < N && r < n; ++c) {
+            i32 p = r;
+            while (p < n && !a[p][c]) ++p;
+            if (p == n) continue;
+
+            if (p != r) {
+                std::swap(a[p], a[r]);
+                swap(p, r);
+            }
+
+            // Words left of the pivot are already zero in both rows
+            const usize w = c / std::numeric_limits<u64>::digits;
+            for (i32 i = rref ? 0 : r + 1; i < n; ++i) {
+                if (i == r || !a[i][c]) continue;
+
+                std::transform(a[i].wbegin() + w, a[i].wend(), a[r].cwbegin() + w, a[i].wbegin() + w, std::bit_xor<u64>());
+                add(i, r);
+            }
+
+            piv.push_back(static_cast<i32>(c));
+            ++r;
+        }
+
+        return piv;
+    }
+
+    std::vector<i32> eliminate(bool rref = true) {
+        return eliminate(rref, [](i32, i32) {}, [](i32, i32) {});
+    }
+
+    i32 rank() const {
+        return static_cast<i32>(gf2_matrix(*this).eliminate(false).size());
+    }
+
+    // Some x with a x = b (free variables set to 0)
+    std::optional<row_type> solve(std::vector<bool> b) const {
+        assert(static_cast<i32>(b.size()) == n);
+
+        gf2_matrix g(*this);
+        const auto piv = g.eliminate(
+            true, [&](i32 i, i32 j) { b.swap(b[i], b[j]); }, [&](i32 i, i32 j) { b[i] = b[i] ^ b[j]; });
+
+        const i32 r = static_cast<i32>(piv.size());
+        for (i32 i = r; i < n; ++i)
+            if (b[i]) return std::nullopt;
+
+        row_type x;
+        for (i32 i = 0; i < r; ++i)
+            if (b[i]) x.set(piv[i]);
+
+        return x;
+    }
+
+    // Basis of {x : a x = 0}
+    std::vector<row_type> kernel() const {
+        gf2_matrix g(*this);
+        const auto piv = g.eliminate();
+
+        std::vector<bool> is_piv(N);
+        for (const i32 c : piv) is_piv[c] = true;
+
+        std::vector<row_type> ker;
+        for (usize c = 0; c < N; ++c) {
+            if (is_piv[c]) continue;
+
+            row_type x;
+            x.set(c);
+            for (i32 i = 0; i < static_cast<i32>(piv.size()); ++i)
+                if (g[i][c]) x.set(piv[i]);
+
+            ker.push_back(x);
+        }
+
+        return ker;
+    }
+
+    std::optional<gf2_matrix> inv() const {
+        assert(n == static_cast<i32>(N));
+
+        gf2_matrix g(*this), r = eye();
+        const auto piv = g.eliminate(
+            true, [&](i32 i, i32 j) { std::swap(r[i], r[j]); }, [&](i32 i, i32 j) { r[i] ^= r[j]; });
+
+        if (static_cast<i32>(piv.size()) < n) return std::nullopt;
+        return r;
+    }
+
+    friend bool operator==(const gf2_matrix &lhs, const gf2_matrix &rhs) {
+        return lhs.n == rhs.n && std::equal(lhs.a.begin(), lhs.a.end(), rhs.a.begin());
+    }
+};
+
+// Four Russians: rows of rhs are grouped 8 at a time and all 256 of their sums are tabulated,
+// so each row of the product costs N / 8 row xors instead of N
+template <usize N, usize M>
+gf2_matrix<M> operator*(const gf2_matrix<N> &lhs, const gf2_matrix<M> &rhs) {
+    assert(rhs.n == static_cast<i32>(N));
+
+    constexpr usize K = 8;
+    constexpr usize ws = std::numeric_limits<u64>::digits;
+
+    gf2_matrix<M> res(lhs.n);
+    std::array<bitset<M>, 1 << K> t;
+
+    for (usize c = 0; c < N; c += K) {
+        const usize g = std::min(K, N - c);
+
+        t[0].unset();
+        for (usize x = 1; x < (usize(1) << g); ++x) t[x] = t[x & (x - 1)] ^ rhs[static_cast<i32>(c + lowbit(x))];
+
+        for (i32 i = 0; i < lhs.n; ++i) {
+            const usize x = (lhs[i].word(c / ws) >> (c % ws)) & ((usize(1) << g) - 1);
+            if (x != 0) res[i] ^= t[x];
+        }
+    }
+
+    return res;
+}
+
+#endif // LIB_GF2_MATRIX_HPP
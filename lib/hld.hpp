@@ -3,14 +3,68 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <optional>
 #include <vector>
 
 #include <lib/prelude.hpp>
 
+// The per-vertex arrays are indexed by vertex; ch is indexed by position in tour and holds what a
+// path walk reads at every step, so following a path costs one load per chain
 struct hld {
+    // Position of the first vertex of the chain and of its parent (-1 for the root chain)
+    struct chain {
+        i32 head, up;
+    };
+
+    // Positions [l, r) of tour on a path, walked from r - 1 down to l (towards the root) if up
+    struct path_segment {
+        i32 l, r;
+        bool up;
+    };
+
+    // The segments of the path from u to v, without allocating; the up ones come in path order and
+    // the others in reverse path order, interleaved, so a non-commutative product keeps two accumulators
+    struct path_iterator {
+        const chain *ch;
+        i32 a, b;
+
+        path_segment operator*() const {
+            if (ch[a].head == ch[b].head) return a < b ? path_segment{a, b + 1, false} : path_segment{b, a + 1, true};
+            return a < b ? path_segment{ch[b].head, b + 1, false} : path_segment{ch[a].head, a + 1, true};
+        }
+
+        path_iterator &operator++() {
+            if (ch[a].head == ch[b].head)
+                a = b = -1;
+            else if (a < b)
+                b = ch[b].up;
+            else
+                a = ch[a].up;
+
+            return *this;
+        }
+
+        bool operator!=(const path_iterator &o) const {
+            return a != o.a || b != o.b;
+        }
+    };
+
+    struct path_range {
+        path_iterator s;
+
+        path_iterator begin() const {
+            return s;
+        }
+
+        path_iterator end() const {
+            return {s.ch, -1, -1};
+        }
+    };
+
     i32 n, time;
     std::vector<i32> sz, tin, depth, par, tour, best, start;
+    std::vector<chain> ch;
 
     hld() {}
 
@@ -28,6 +82,8 @@ struct hld {
         build(g, 0);
     }
 
+    // Iterative: a BFS order gives the parents and depths, sizes and heavy children are summed up
+    // in reverse of it, and an explicit stack lays out the chains with the heavy child popped first
     template <typename Tree>
     void build(const Tree &g, i32 root) {
         n = static_cast<i32>(g.size());
@@ -40,12 +96,61 @@ struct hld {
         tour.assign(n, 0);
         best.assign(n, -1);
         start.assign(n, 0);
+        ch.assign(n, {});
 
         par[root] = -1;
-        dfs_sz(g, root);
+        tour[0] = root;
+        for (i32 i = 0, k = 1; i < k; ++i) {
+            const i32 u = tour[i];
+            for (const i32 v : g[u]) {
+                if (v == par[u]) continue;
+
+                par[v] = u;
+                depth[v] = depth[u] + 1;
+                tour[k++] = v;
+            }
+        }
+
+        for (i32 i = n - 1; i > 0; --i) {
+            const i32 u = tour[i], t = par[u];
+            sz[t] += sz[u];
+            if (best[t] == -1 || sz[u] >= sz[best[t]]) best[t] = u;
+        }
 
+        std::vector<i32> st;
+        st.reserve(n);
+        st.push_back(root);
         start[root] = root;
-        dfs_hld(g, root);
+
+        while (!st.empty()) {
+            const i32 u = st.back();
+            st.pop_back();
+
+            tour[time] = u;
+            tin[u] = time++;
+
+            // Light children reversed so that they pop in the order of g[u], as in a recursive DFS
+            const i32 x = best[u];
+            const usize k = st.size();
+            for (const i32 v : g[u]) {
+                if (v == par[u] || v == x) continue;
+
+                start[v] = v;
+                st.push_back(v);
+            }
+
+            std::reverse(st.begin() + static_cast<std::ptrdiff_t>(k), st.end());
+
+            if (x != -1) {
+                start[x] = start[u];
+                st.push_back(x);
+            }
+        }
+
+        for (i32 i = 0; i < n; ++i) {
+            const i32 s = start[tour[i]];
+            ch[i] = {tin[s], par[s] == -1 ? -1 : tin[par[s]]};
+        }
     }
 
     bool is_ancestor(i32 u, i32 v) const {
@@ -76,13 +181,15 @@ struct hld {
         assert(0 <= u && u < n);
         assert(0 <= v && v < n);
 
-        if (is_ancestor(u, v)) return u;
-        if (is_ancestor(v, u)) return v;
-
-        for (; start[u] != start[v]; v = par[start[v]])
-            if (depth[start[u]] > depth[start[v]]) std::swap(u, v);
+        i32 a = tin[u], b = tin[v];
+        while (ch[a].head != ch[b].head) {
+            if (a < b)
+                b = ch[b].up;
+            else
+                a = ch[a].up;
+        }
 
-        return depth[u] < depth[v] ? u : v;
+        return tour[std::min(a, b)];
     }
 
     i32 dist(i32 u, i32 v) const {
@@ -120,6 +227,13 @@ struct hld {
             return jump(v, l + r - k);
     }
 
+    path_range path(i32 u, i32 v) const {
+        assert(0 <= u && u < n);
+        assert(0 <= v && v < n);
+
+        return {{ch.data(), tin[u], tin[v]}};
+    }
+
     std::vector<std::pair<i32, i32>> decompose(i32 u, i32 v) const {
         assert(0 <= u && u < n);
         assert(0 <= v && v < n);
@@ -144,46 +258,6 @@ struct hld {
         up.insert(up.end(), dn.rbegin(), dn.rend());
         return up;
     }
-
-private:
-    template <typename Tree>
-    void dfs_sz(const Tree &g, i32 u) {
-        i32 &x = best[u];
-        const i32 t = par[u];
-
-        for (const i32 v : g[u]) {
-            if (v == t) continue;
-
-            par[v] = u;
-            depth[v] = depth[u] + 1;
-
-            dfs_sz(g, v);
-
-            sz[u] += sz[v];
-            if (x == -1 || sz[v] > sz[x]) x = v;
-        }
-    }
-
-    template <typename Tree>
-    void dfs_hld(const Tree &g, i32 u) {
-        tour[time] = u;
-        tin[u] = time++;
-
-        const i32 x = best[u];
-        const i32 t = par[u];
-
-        if (x != -1) {
-            start[x] = start[u];
-            dfs_hld(g, x);
-        }
-
-        for (const i32 v : g[u]) {
-            if (v == t || v == x) continue;
-
-            start[v] = v;
-            dfs_hld(g, v);
-        }
-    }
 };
 
 #endif // LIB_HLD_HPP
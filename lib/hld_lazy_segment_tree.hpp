@@ -78,10 +78,17 @@ struct hld_lazy_segment_tree {
     }
 
     X prod_path(i32 u, i32 v) {
-        X x = MX::unit();
-        for (const auto &[s, t] : h.decompose(u, v)) x = MX::op(x, prod(s, t));
+        X x = MX::unit(), y = MX::unit();
+        for (const auto &[l, r, up] : h.path(u, v)) {
+            if (!up)
+                y = MX::op(st.prod(l, r), y);
+            else if constexpr (!MX::commutative)
+                x = MX::op(x, rst.prod(l, r));
+            else
+                x = MX::op(x, st.prod(l, r));
+        }
 
-        return x;
+        return MX::op(x, y);
     }
 
     X prod_subtree(i32 u) {
@@ -94,11 +101,9 @@ struct hld_lazy_segment_tree {
     }
 
     void apply_path(i32 u, i32 v, const A &a) {
-        for (const auto &[s, t] : h.decompose(u, v)) {
-            const auto &[x, y] = std::minmax(h.tin[s], h.tin[t]);
-
-            st.apply(x, y + 1, a);
-            if constexpr (!MX::commutative) rst.apply(x, y + 1, a);
+        for (const auto &[l, r, up] : h.path(u, v)) {
+            st.apply(l, r, a);
+            if constexpr (!MX::commutative) rst.apply(l, r, a);
         }
     }
 
@@ -121,17 +126,6 @@ struct hld_lazy_segment_tree {
             rst.apply(y, h.n, a);
         }
     }
-
-private:
-    X prod(i32 u, i32 v) {
-        const i32 a = h.tin[u];
-        const i32 b = h.tin[v];
-
-        if (a <= b) return st.prod(a, b + 1);
-        if constexpr (!MX::commutative) return rst.prod(b, a + 1);
-
-        return st.prod(b, a + 1);
-    }
 };
 
 #endif // LIB_HLD_LAZY_SEGMENT_TREE_HPP
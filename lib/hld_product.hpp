@@ -70,27 +70,23 @@ struct hld_product {
     }
 
     X prod_path(i32 u, i32 v) const {
-        X x = MX::unit();
-        for (const auto &[s, t] : h.decompose(u, v)) x = MX::op(x, prod(s, t));
-
-        return x;
+        X x = MX::unit(), y = MX::unit();
+        for (const auto &[l, r, up] : h.path(u, v)) {
+            if (!up)
+                y = MX::op(st.prod(l, r), y);
+            else if constexpr (!MX::commutative)
+                x = MX::op(x, rst.prod(l, r));
+            else
+                x = MX::op(x, st.prod(l, r));
+        }
+
+        return MX::op(x, y);
     }
 
     X prod_subtree(i32 u) const {
         static_assert(MX::commutative);
         return st.prod(h.tin[u], h.tin[u] + h.sz[u]);
     }
-
-private:
-    X prod(i32 u, i32 v) const {
-        const i32 a = h.tin[u];
-        const i32 b = h.tin[v];
-
-        if (a <= b) return st.prod(a, b + 1);
-        if constexpr (!MX::commutative) return rst.prod(b, a + 1);
-
-        return st.prod(b, a + 1);
-    }
 };
 
 #endif // LIB_HLD_PRODUCT_HPP
@@ -7,10 +7,10 @@
 #include <lib/prelude.hpp>
 #include <lib/wavelet_matrix.hpp>
 
-template <typename T>
+template <typename T, typename BitVector = bit_vector>
 struct hld_wavelet_matrix {
     const hld &h;
-    wavelet_matrix<T> wm;
+    wavelet_matrix<T, BitVector> wm;
 
     explicit hld_wavelet_matrix(const hld &g, const std::vector<T> &v)
         : h(g) {
@@ -5,10 +5,10 @@
 #include <lib/prelude.hpp>
 #include <lib/wavelet_matrix_product.hpp>
 
-template <typename T, typename RangeProduct>
+template <typename T, typename RangeProduct, typename BitVector = bit_vector>
 struct hld_wavelet_matrix_product {
     const hld &h;
-    wavelet_matrix_product<T, RangeProduct> wm;
+    wavelet_matrix_product<T, RangeProduct, BitVector> wm;
 
     using MX = typename RangeProduct::MX;
     using X = typename MX::ValueT;
@@ -6,6 +6,7 @@
 
 #include <lib/bits.hpp>
 #include <lib/prelude.hpp>
+#include <lib/static_search.hpp>
 
 template <typename T>
 struct line {
@@ -31,13 +32,15 @@ struct line {
     }
 };
 
-template <typename L, bool MIN = true>
+// Search is sorted_search or eytzinger_search, used to find the position of a coordinate
+template <typename L, bool MIN = true, typename Search = sorted_search<typename L::ValueT>>
 struct lichao_tree {
     using T = typename L::ValueT;
 
     i32 n, log, size;
     std::vector<T> x;
     std::vector<L> d;
+    Search sr;
 
     lichao_tree() {}
 
@@ -51,6 +54,7 @@ struct lichao_tree {
         std::sort(x.begin(), x.end());
         x.erase(std::unique(x.begin(), x.end()), x.end());
         x.shrink_to_fit();
+        sr.build(x);
 
         n = static_cast<i32>(x.size());
 
@@ -91,7 +95,7 @@ struct lichao_tree {
 
 private:
     inline i32 idx(T z) const {
-        return static_cast<i32>(std::lower_bound(x.begin(), x.end(), z) - x.begin());
+        return sr.lower_bound(x, z);
     }
 
     inline T eval(const L &f, i32 i) const {
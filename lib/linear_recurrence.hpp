@@ -0,0 +1,125 @@
+#ifndef LIB_LINEAR_RECURRENCE_HPP
+#define LIB_LINEAR_RECURRENCE_HPP 1
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <lib/berlekamp_massey.hpp>
+#include <lib/bits.hpp>
+#include <lib/convolution_ntt.hpp>
+#include <lib/prelude.hpp>
+
+// Keeps the coefficients of u with the same parity as p
+template <typename Z>
+std::vector<Z> bostan_mori_half(const std::vector<Z> &u, i32 p) {
+    std::vector<Z> v;
+    v.reserve(u.size() / 2 + 1);
+    for (usize i = p; i < u.size(); i += 2) v.push_back(u[i]);
+
+    return v;
+}
+
+// [x^N] P(x) / Q(x), Q[0] must be invertible
+template <typename Z>
+Z bostan_mori(std::vector<Z> P, std::vector<Z> Q, u64 N) {
+    assert(!Q.empty() && Q[0] != 0);
+    if (P.empty()) return 0;
+
+    for (; N != 0; N >>= 1) {
+        std::vector<Z> R(Q);
+        for (usize i = 1; i < R.size(); i += 2) R[i] = -R[i];
+
+        const convolution_ntt_fixed<Z> F(std::move(R), static_cast<i32>(std::max(P.size(), Q.size())));
+
+        P = bostan_mori_half(F.convolution(std::move(P)), N & 1);
+        Q = bostan_mori_half(F.convolution(std::move(Q)), 0);
+
+        if (P.empty()) return 0;
+    }
+
+    return P[0] / Q[0];
+}
+
+// [x^N] P(x) / Q(x) for every N in Ns
+// The chain Q(x) Q(-x) does not depend on N, so its transforms are shared by all queries
+template <typename Z>
+std::vector<Z> bostan_mori(const std::vector<Z> &P, std::vector<Z> Q, const std::vector<u64> &Ns) {
+    assert(!Q.empty() && Q[0] != 0);
+
+    const i32 q = static_cast<i32>(Ns.size());
+    std::vector<Z> res(q);
+    if (P.empty() || q == 0) return res;
+
+    const u64 mx = *std::max_element(Ns.begin(), Ns.end());
+    const i32 log = mx == 0 ? 0 : static_cast<i32>(topbit(mx)) + 1;
+    const i32 m = static_cast<i32>(std::max(P.size(), Q.size()));
+
+    std::vector<convolution_ntt_fixed<Z>> fs(log);
+    std::vector<Z> c(log + 1);
+
+    c[0] = Q[0];
+    for (i32 d = 0; d < log; ++d) {
+        std::vector<Z> R(Q);
+        for (usize i = 1; i < R.size(); i += 2) R[i] = -R[i];
+
+        fs[d].build(std::move(R), m);
+
+        Q = bostan_mori_half(fs[d].convolution(std::move(Q)), 0);
+        c[d + 1] = Q[0];
+    }
+
+    for (i32 j = 0; j < q; ++j) {
+        u64 N = Ns[j];
+        std::vector<Z> p(P);
+
+        i32 d = 0;
+        for (; N != 0 && !p.empty(); N >>= 1, ++d) p = bostan_mori_half(fs[d].convolution(std::move(p)), N & 1);
+
+        res[j] = p.empty() ? Z() : p[0] / c[d];
+    }
+
+    return res;
+}
+
+// Denominator and numerator of the generating function of a,
+// where a[i] = sum_j c[j] a[i - 1 - j] (the output format of berlekamp_massey)
+template <typename Z>
+std::pair<std::vector<Z>, std::vector<Z>> linear_recurrence_fraction(const std::vector<Z> &a, const std::vector<Z> &c) {
+    const i32 d = static_cast<i32>(c.size());
+    assert(static_cast<i32>(a.size()) >= d);
+
+    std::vector<Z> Q(d + 1);
+    Q[0] = 1;
+    for (i32 i = 0; i < d; ++i) Q[i + 1] = -c[i];
+
+    std::vector<Z> P(a.begin(), a.begin() + d);
+    if (d != 0) P = convolution_ntt(std::move(P), Q, d);
+
+    return {P, Q};
+}
+
+template <typename Z>
+Z linear_recurrence(const std::vector<Z> &a, const std::vector<Z> &c, u64 N) {
+    const auto [P, Q] = linear_recurrence_fraction(a, c);
+    return bostan_mori(P, Q, N);
+}
+
+template <typename Z>
+std::vector<Z> linear_recurrence(const std::vector<Z> &a, const std::vector<Z> &c, const std::vector<u64> &Ns) {
+    const auto [P, Q] = linear_recurrence_fraction(a, c);
+    return bostan_mori(P, Q, Ns);
+}
+
+// N-th term of the sequence whose prefix is a, recovering its recurrence with berlekamp_massey
+template <typename Z>
+Z find_nth_term(const std::vector<Z> &a, u64 N) {
+    return linear_recurrence(a, berlekamp_massey(a), N);
+}
+
+template <typename Z>
+std::vector<Z> find_nth_terms(const std::vector<Z> &a, const std::vector<u64> &Ns) {
+    return linear_recurrence(a, berlekamp_massey(a), Ns);
+}
+
+#endif // LIB_LINEAR_RECURRENCE_HPP
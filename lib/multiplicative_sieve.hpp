@@ -0,0 +1,78 @@
+#ifndef LIB_MULTIPLICATIVE_SIEVE_HPP
+#define LIB_MULTIPLICATIVE_SIEVE_HPP 1
+
+#include <vector>
+
+#include <lib/prelude.hpp>
+
+// mu, phi, d (number of divisors) and sigma (sum of divisors) of every k <= n in one linear sieve
+// pw[k] is the largest power of the least prime factor dividing k
+struct multiplicative_sieve {
+    i32 n;
+    std::vector<i32> pr, mu, phi, d;
+    std::vector<i64> sigma;
+
+    multiplicative_sieve() {}
+    explicit multiplicative_sieve(i32 m) {
+        build(m);
+    }
+
+    void build(i32 m) {
+        n = m;
+
+        pr.clear();
+        mu.assign(n + 1, 0);
+        phi.assign(n + 1, 0);
+        d.assign(n + 1, 0);
+        sigma.assign(n + 1, 0);
+
+        std::vector<i32> pw(n + 1), e(n + 1);
+        if (n >= 1) mu[1] = phi[1] = d[1] = sigma[1] = 1;
+
+        for (i32 i = 2; i <= n; ++i) {
+            if (pw[i] == 0) {
+                pr.push_back(i);
+                pw[i] = i;
+                e[i] = 1;
+                mu[i] = -1;
+                phi[i] = i - 1;
+                d[i] = 2;
+                sigma[i] = i + 1;
+            }
+
+            for (const i32 p : pr) {
+                if (i64(i) * p > n) break;
+
+                const i32 k = i * p;
+                if (i % p != 0) {
+                    pw[k] = p;
+                    e[k] = 1;
+                    mu[k] = -mu[i];
+                    phi[k] = phi[i] * (p - 1);
+                    d[k] = d[i] * 2;
+                    sigma[k] = sigma[i] * (p + 1);
+                    continue;
+                }
+
+                pw[k] = pw[i] * p;
+                e[k] = e[i] + 1;
+
+                // k = q * p^e with q coprime to p
+                const i32 q = k / pw[k];
+                if (q == 1) {
+                    phi[k] = k - k / p;
+                    d[k] = e[k] + 1;
+                    sigma[k] = sigma[i] * p + 1;
+                } else {
+                    phi[k] = phi[q] * phi[pw[k]];
+                    d[k] = d[q] * d[pw[k]];
+                    sigma[k] = sigma[q] * sigma[pw[k]];
+                }
+
+                break;
+            }
+        }
+    }
+};
+
+#endif // LIB_MULTIPLICATIVE_SIEVE_HPP
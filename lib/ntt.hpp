@@ -1,15 +1,265 @@
 #ifndef LIB_NTT_HPP
 #define LIB_NTT_HPP 1
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <type_traits>
 #include <vector>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include <lib/bits.hpp>
 #include <lib/prelude.hpp>
+#include <lib/static_montgomery_modint.hpp>
+
+template <typename>
+struct is_static_montgomery_modint_32 : std::false_type {};
+
+template <u32 m>
+struct is_static_montgomery_modint_32<static_montgomery_modint_32<m>> : std::true_type {};
+
+template <typename Z>
+constexpr bool is_static_montgomery_modint_32_v = is_static_montgomery_modint_32<Z>::value;
+
+// Radix-4 NTT working directly on the Montgomery representation of Z.
+// Produces exactly the same (bit-reversed) order as the generic ntt below.
+// Values are kept in [0, 2m) between stages and in [0, 4m) inside a butterfly.
+template <typename Z>
+struct montgomery_ntt {
+    static constexpr u32 m = Z::mod();
+    static constexpr u32 m2 = 2 * m;
+    static constexpr u32 nr = -Z::r;
+
+    static_assert(sizeof(Z) == sizeof(u32));
+
+    // rt[k] = {w_2k, w_k, w_k * w_2k} where w_k is the twiddle of the k-th block
+    static inline std::vector<std::array<u32, 3>> rt, irt;
+    static inline u32 J, IJ;
+
+    [[gnu::always_inline]] static u32 raw(Z x) {
+        const u32 v = *reinterpret_cast<const u32 *>(&x);
+        return v >= m ? v - m : v;
+    }
+
+    [[gnu::always_inline]] static u32 reduce(u64 b) {
+        return static_cast<u32>((b + u64(u32(b) * nr) * m) >> 32);
+    }
+
+    [[gnu::always_inline]] static u32 shrink(u32 x) {
+        return x >= m2 ? x - m2 : x;
+    }
+
+    static void prepare(i32 n) {
+        if (static_cast<i32>(rt.size()) * 4 >= n) return;
+
+        std::array<Z, 30> dw, iw;
+
+        Z root = 2;
+        while (root.pow((m - 1) / 2) == 1) root += 1;
+
+        for (i32 i = 0; i < 30; ++i) {
+            dw[i] = -root.pow((m - 1) >> (i + 2));
+            iw[i] = dw[i].inv();
+        }
+
+        J = raw(dw[0]);
+        IJ = raw(iw[0]);
+
+        const i32 h = std::max(n / 2, 2);
+        std::vector<Z> w(h), iv(h);
+
+        w[0] = iv[0] = 1;
+        for (i32 k = 1; k < h; ++k) {
+            w[k] = w[k - 1] * dw[lowbit(k)];
+            iv[k] = iv[k - 1] * iw[lowbit(k)];
+        }
+
+        rt.resize(h / 2);
+        irt.resize(h / 2);
+
+        for (i32 k = 0; k < h / 2; ++k) {
+            rt[k] = {raw(w[2 * k]), raw(w[k]), raw(w[k] * w[2 * k])};
+            irt[k] = {raw(iv[2 * k]), raw(iv[k]), raw(iv[k] * iv[2 * k])};
+        }
+    }
+
+#ifdef __AVX2__
+    [[gnu::always_inline]] static __m256i mul(__m256i a, __m256i b) {
+        const __m256i vm = _mm256_set1_epi32(m);
+        const __m256i vr = _mm256_set1_epi32(nr);
+
+        const __m256i pe = _mm256_mul_epu32(a, b);
+        const __m256i po = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+
+        const __m256i qe = _mm256_mul_epu32(_mm256_mul_epu32(pe, vr), vm);
+        const __m256i qo = _mm256_mul_epu32(_mm256_mul_epu32(po, vr), vm);
+
+        const __m256i re = _mm256_srli_epi64(_mm256_add_epi64(pe, qe), 32);
+        const __m256i ro = _mm256_add_epi64(po, qo);
+
+        return _mm256_blend_epi32(re, ro, 0b10101010);
+    }
+
+    [[gnu::always_inline]] static __m256i shrink(__m256i x) {
+        return _mm256_min_epu32(x, _mm256_sub_epi32(x, _mm256_set1_epi32(m2)));
+    }
+#endif
+
+    static void transform(u32 *a, i32 n) {
+        i32 q = n >> 2;
+        if (topbit(n) & 1) {
+            q >>= 1;
+
+            const i32 h = n >> 1;
+            for (i32 i = 0; i < h; ++i) {
+                const u32 x = a[i], y = a[i + h];
+                a[i] = shrink(x + y);
+                a[i + h] = shrink(x - y + m2);
+            }
+        }
+
+        for (; q >= 1; q >>= 2) {
+            for (i32 s = 0, k = 0; s < n; s += 4 * q, ++k) {
+                const auto [w1, w2, w3] = rt[k];
+
+                u32 *a0 = a + s, *a1 = a0 + q, *a2 = a1 + q, *a3 = a2 + q;
+
+                i32 i = 0;
+#ifdef __AVX2__
+                if (q >= 8) {
+                    const __m256i v1 = _mm256_set1_epi32(w1);
+                    const __m256i v2 = _mm256_set1_epi32(w2);
+                    const __m256i v3 = _mm256_set1_epi32(w3);
+                    const __m256i vj = _mm256_set1_epi32(J);
+                    const __m256i vm2 = _mm256_set1_epi32(m2);
+
+                    for (; i < q; i += 8) {
+                        const __m256i t0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a0 + i));
+                        const __m256i t1 = mul(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a1 + i)), v1);
+                        const __m256i t2 = mul(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a2 + i)), v2);
+                        const __m256i t3 = mul(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a3 + i)), v3);
+
+                        const __m256i s02 = shrink(_mm256_add_epi32(t0, t2));
+                        const __m256i d02 = shrink(_mm256_add_epi32(_mm256_sub_epi32(t0, t2), vm2));
+                        const __m256i s13 = shrink(_mm256_add_epi32(t1, t3));
+                        const __m256i u = mul(_mm256_add_epi32(_mm256_sub_epi32(t1, t3), vm2), vj);
+
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(a0 + i), shrink(_mm256_add_epi32(s02, s13)));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(a1 + i),
+                                            shrink(_mm256_add_epi32(_mm256_sub_epi32(s02, s13), vm2)));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(a2 + i), shrink(_mm256_add_epi32(d02, u)));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(a3 + i),
+                                            shrink(_mm256_add_epi32(_mm256_sub_epi32(d02, u), vm2)));
+                    }
+                }
+#endif
+                for (; i < q; ++i) {
+                    const u32 t0 = a0[i];
+                    const u32 t1 = reduce(u64(a1[i]) * w1);
+                    const u32 t2 = reduce(u64(a2[i]) * w2);
+                    const u32 t3 = reduce(u64(a3[i]) * w3);
+
+                    const u32 s02 = shrink(t0 + t2), d02 = shrink(t0 - t2 + m2);
+                    const u32 s13 = shrink(t1 + t3), u = reduce(u64(t1 - t3 + m2) * J);
+
+                    a0[i] = shrink(s02 + s13);
+                    a1[i] = shrink(s02 - s13 + m2);
+                    a2[i] = shrink(d02 + u);
+                    a3[i] = shrink(d02 - u + m2);
+                }
+            }
+        }
+    }
+
+    static void inverse_transform(u32 *a, i32 n) {
+        i32 q = 1;
+        for (; 4 * q <= n; q <<= 2) {
+            for (i32 s = 0, k = 0; s < n; s += 4 * q, ++k) {
+                const auto [w1, w2, w3] = irt[k];
+
+                u32 *a0 = a + s, *a1 = a0 + q, *a2 = a1 + q, *a3 = a2 + q;
+
+                i32 i = 0;
+#ifdef __AVX2__
+                if (q >= 8) {
+                    const __m256i v1 = _mm256_set1_epi32(w1);
+                    const __m256i v2 = _mm256_set1_epi32(w2);
+                    const __m256i v3 = _mm256_set1_epi32(w3);
+                    const __m256i vj = _mm256_set1_epi32(IJ);
+                    const __m256i vm2 = _mm256_set1_epi32(m2);
+
+                    for (; i < q; i += 8) {
+                        const __m256i c0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a0 + i));
+                        const __m256i c1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a1 + i));
+                        const __m256i c2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a2 + i));
+                        const __m256i c3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a3 + i));
+
+                        const __m256i s01 = shrink(_mm256_add_epi32(c0, c1));
+                        const __m256i d01 = shrink(_mm256_add_epi32(_mm256_sub_epi32(c0, c1), vm2));
+                        const __m256i s23 = shrink(_mm256_add_epi32(c2, c3));
+                        const __m256i u = mul(_mm256_add_epi32(_mm256_sub_epi32(c2, c3), vm2), vj);
+
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(a0 + i), shrink(_mm256_add_epi32(s01, s23)));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(a1 + i), mul(_mm256_add_epi32(d01, u), v1));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(a2 + i),
+                                            mul(_mm256_add_epi32(_mm256_sub_epi32(s01, s23), vm2), v2));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(a3 + i),
+                                            mul(_mm256_add_epi32(_mm256_sub_epi32(d01, u), vm2), v3));
+                    }
+                }
+#endif
+                for (; i < q; ++i) {
+                    const u32 c0 = a0[i], c1 = a1[i], c2 = a2[i], c3 = a3[i];
+
+                    const u32 s01 = shrink(c0 + c1), d01 = shrink(c0 - c1 + m2);
+                    const u32 s23 = shrink(c2 + c3), u = reduce(u64(c2 - c3 + m2) * IJ);
+
+                    a0[i] = shrink(s01 + s23);
+                    a1[i] = reduce(u64(d01 + u) * w1);
+                    a2[i] = reduce(u64(s01 - s23 + m2) * w2);
+                    a3[i] = reduce(u64(d01 - u + m2) * w3);
+                }
+            }
+        }
+
+        if (q < n) {
+            const i32 h = n >> 1;
+            for (i32 i = 0; i < h; ++i) {
+                const u32 x = a[i], y = a[i + h];
+                a[i] = shrink(x + y);
+                a[i + h] = shrink(x - y + m2);
+            }
+        }
+    }
+
+    static void run(std::vector<Z> &a, bool inv) {
+        const i32 n = static_cast<i32>(a.size());
+        assert((n & (n - 1)) == 0);
+
+        if (n <= 1) return;
+        prepare(n);
+
+        u32 *p = reinterpret_cast<u32 *>(a.data());
+        if (!inv) {
+            transform(p, n);
+        } else {
+            inverse_transform(p, n);
+
+            const Z r = Z(n).inv();
+            for (auto &&e : a) e *= r;
+        }
+    }
+};
 
 template <typename Z>
 void ntt(std::vector<Z> &a, bool inv) {
+    if constexpr (is_static_montgomery_modint_32_v<Z>) {
+        return montgomery_ntt<Z>::run(a, inv);
+    }
+
     static std::array<Z, 30> dw{}, iw{};
     if (dw[0] == 0) {
         Z root = 2;
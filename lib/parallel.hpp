@@ -0,0 +1,59 @@
+#ifndef LIB_PARALLEL_HPP
+#define LIB_PARALLEL_HPP 1
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <lib/prelude.hpp>
+
+// Calls f(i, j) for every i in [0, m) on up to t threads, j being the thread running it
+template <typename F>
+void parallel_for(i32 t, u64 m, F f) {
+    t = static_cast<i32>(std::min<u64>(std::max(t, 1), m));
+    if (t <= 1) {
+        for (u64 i = 0; i < m; ++i) f(i, 0);
+        return;
+    }
+
+    std::vector<std::thread> ths;
+    for (i32 j = 0; j < t; ++j)
+        ths.emplace_back([&, j]() {
+            for (u64 i = j; i < m; i += t) f(i, j);
+        });
+
+    for (auto &&th : ths) th.join();
+}
+
+// Bounds of t chunks of [0, n): chunk j is [ch[j], ch[j + 1]), and every chunk but the last one
+// is whole words of 64, so threads setting bits of their own chunks never share a word
+inline std::vector<i32> word_chunks(i32 n, i32 t) {
+    std::vector<i32> ch(t + 1);
+    for (i32 j = 0; j < t; ++j) ch[j] = static_cast<i32>(i64(n >> 6) * j / t) << 6;
+    ch[t] = n;
+
+    return ch;
+}
+
+// Sorts t chunks of a in parallel, then merges neighbouring runs pairwise, every round in parallel
+template <typename T, typename Compare = std::less<>>
+void parallel_sort(std::vector<T> &a, i32 t, Compare cmp = {}) {
+    const u64 n = a.size();
+    t = static_cast<i32>(std::min<u64>(std::max(t, 1), std::max<u64>(n, 1)));
+
+    std::vector<u64> b(t + 1);
+    for (i32 j = 0; j <= t; ++j) b[j] = n * j / t;
+
+    parallel_for(t, t, [&](u64 j, i32) { std::sort(a.begin() + b[j], a.begin() + b[j + 1], cmp); });
+
+    for (i32 w = 1; w < t; w *= 2) {
+        const i32 m = (t - w + 2 * w - 1) / (2 * w);
+        parallel_for(m, m, [&](u64 k, i32) {
+            const i32 l = static_cast<i32>(k) * 2 * w;
+            std::inplace_merge(a.begin() + b[l], a.begin() + b[l + w], a.begin() + b[std::min(l + 2 * w, t)], cmp);
+        });
+    }
+}
+
+#endif // LIB_PARALLEL_HPP
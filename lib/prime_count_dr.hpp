@@ -0,0 +1,230 @@
+#ifndef LIB_PRIME_COUNT_DR_HPP
+#define LIB_PRIME_COUNT_DR_HPP 1
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <lib/bits.hpp>
+#include <lib/parallel.hpp>
+#include <lib/prelude.hpp>
+#include <lib/prime_count.hpp>
+#include <lib/segmented_sieve.hpp>
+#include <lib/sieve.hpp>
+
+// Deleglise-Rivat: pi(x) = phi(x, a) + a - 1 - P2(x, a) with a = pi(y) and y ~ x^(1/3)
+// phi(x, a) is split into ordinary leaves, easy special leaves answered from a pi table up to sqrt(x)
+// and hard special leaves answered while sieving [1, x / y); the last two phases and P2 use t threads
+inline i64 prime_count_dr(const i64 x, i32 t = 1) {
+    if (x < (i64(1) << 24)) return prime_count(x);
+
+    t = std::max(t, 1);
+
+    i64 sq = static_cast<i64>(std::sqrt(static_cast<f64>(x)));
+    while (sq * sq > x) --sq;
+    while ((sq + 1) * (sq + 1) <= x) ++sq;
+
+    i64 cb = static_cast<i64>(std::cbrt(static_cast<f64>(x)));
+    while (cb * cb * cb > x) --cb;
+    while ((cb + 1) * (cb + 1) * (cb + 1) <= x) ++cb;
+
+    const f64 lg = std::log(static_cast<f64>(x));
+    const i64 y = std::min(sq - 1, static_cast<i64>(cb * std::max(1.0, lg * lg / 100)));
+    const i64 z = x / y;
+
+    const auto ps = segmented_sieve(sq).primes(0, sq + 1, t);
+    const i32 K = static_cast<i32>(ps.size());
+
+    // pi(v) for v <= sq, one counter per 64 numbers
+    std::vector<u64> bs(sq / 64 + 1);
+    std::vector<i32> bc(sq / 64 + 1);
+    for (const u64 p : ps) bs[p / 64] |= u64(1) << (p % 64);
+    for (usize i = 1; i < bs.size(); ++i) bc[i] = bc[i - 1] + static_cast<i32>(popcnt(bs[i - 1]));
+
+    const auto pi = [&](i64 v) -> i64 { return bc[v / 64] + popcnt(bs[v / 64] & (~u64(0) >> (63 - v % 64))); };
+
+    const i32 a = static_cast<i32>(pi(y));
+
+    const sieve sv(static_cast<i32>(y));
+    std::vector<i32> mu(y + 1);
+    mu[1] = 1;
+    for (i32 m = 2; m <= y; ++m) {
+        const i32 p = sv.lp[m], q = m / p;
+        mu[m] = sv.lp[q] == p ? 0 : -mu[q];
+    }
+
+    // Ordinary leaves
+    i64 res = a - 1;
+    for (i32 m = 1; m <= y; ++m) res += mu[m] * (x / m);
+
+    // P2: primes p in (y, sq] in decreasing order have increasing x / p >= sq
+    {
+        i64 c = K, k = K;
+        const auto flush = [&](i64 q) {
+            for (; k > a && x / static_cast<i64>(ps[k - 1]) < q; --k) res -= c - k + 1;
+        };
+
+        segmented_sieve(z).enumerate(
+            sq + 1, x / static_cast<i64>(ps[a]) + 1,
+            [&](u64 q) {
+                flush(static_cast<i64>(q));
+                ++c;
+            },
+            t);
+
+        flush(x + 1);
+    }
+
+    // Special leaves -mu(m) phi(x / (p_b m), b - 1) with m <= y < p_b m and lpf(m) > p_b
+    // p_b = 2 is summed directly; for p_b^2 > y, m is a prime q and the leaf is easy while
+    // v = x / (p_b q) is below p_b^2 and sq, i.e. q > qmax[b], where phi(v, b - 1) = max(1, pi(v) - b + 2)
+    std::vector<i64> qmax(a + 1);
+    i32 B = 1;
+    for (i32 b = 2; b <= a; ++b) {
+        const i64 p = static_cast<i64>(ps[b - 1]);
+        if (p * p <= y) {
+            qmax[b] = y;
+        } else {
+            qmax[b] = std::min(y, std::max(x / (p * p * p), x / (p * (sq + 1))));
+            if (qmax[b] <= p) continue;
+        }
+
+        B = b;
+    }
+
+    for (i64 m = y / 2 + 1; m <= y; ++m)
+        if (m % 2 == 1) res -= mu[m] * (x / (2 * m));
+
+    {
+        std::vector<i64> rs(t);
+        parallel_for(t, a + 1, [&](u64 b, i32 j) {
+            const i64 p = static_cast<i64>(ps[b - 1]);
+            if (b < 2 || p * p <= y) return;
+
+            // Consecutive q with the same pi(v) are added as one cluster
+            i64 s = 0;
+            for (i64 k = pi(std::max(p, qmax[b])); k < a;) {
+                const i64 l = pi(x / (p * static_cast<i64>(ps[k])));
+                if (l < static_cast<i64>(b)) {
+                    s += a - k;
+                    break;
+                }
+
+                const i64 w = x / (p * static_cast<i64>(ps[l - 1]));
+                const i64 e = w >= y ? a : pi(w);
+
+                s += (e - k) * (l - static_cast<i64>(b) + 2);
+                k = e;
+            }
+
+            rs[j] += s;
+        });
+
+        for (const i64 s : rs) res += s;
+    }
+
+    // Hard leaves: [1, z) is sieved in segments of 2L numbers, odd ones only, with a counter per C bits
+    // Every thread runs a contiguous range of segments with phi counted from the start of its range;
+    // the missing prefix phi(lo - 1, b - 1) is added afterwards, weighted by the sum of -mu of its leaves
+    constexpr i64 L = i64(1) << 18, C = 512;
+
+    const i64 segs = (z + 2 * L - 1) / (2 * L);
+    t = static_cast<i32>(std::min<i64>(t, segs));
+
+    std::vector<i64> sum(t);
+    std::vector<std::vector<i64>> ws(t, std::vector<i64>(B + 1)), cs(t, std::vector<i64>(B + 1));
+
+    parallel_for(t, t, [&](u64 j, i32) {
+        const i64 s0 = segs * static_cast<i64>(j) / t, s1 = segs * static_cast<i64>(j + 1) / t;
+        const i64 lo0 = std::max<i64>(1, s0 * 2 * L);
+
+        // Next leaf of every b: an integer m for small p_b, an index into ps for large ones
+        std::vector<i64> nx(B + 1);
+        for (i32 b = 2; b <= B; ++b) {
+            const i64 p = static_cast<i64>(ps[b - 1]);
+            const i64 m = std::min(qmax[b], x / (p * lo0));
+
+            nx[b] = p * p <= y ? m : (m > p ? pi(m) - 1 : -1);
+        }
+
+        std::vector<u64> w(L / 64);
+        std::vector<i32> cnt(L / C);
+        auto &wsum = ws[j], &phi = cs[j];
+
+        for (i64 sg = s0; sg < s1; ++sg) {
+            const i64 lo = sg * 2 * L, hi = lo + 2 * L;
+
+            std::fill(w.begin(), w.end(), ~u64(0));
+            std::fill(cnt.begin(), cnt.end(), static_cast<i32>(C));
+            i64 alive = L;
+
+            for (i32 b = 2; b <= B; ++b) {
+                const i64 p = static_cast<i64>(ps[b - 1]);
+
+                // Leaves come in increasing order of v, so the counters are summed incrementally
+                i64 ci = 0, acc = 0;
+                const auto count = [&](i64 v) -> i64 {
+                    const i64 k = (v - lo + 1) / 2;
+                    for (; (ci + 1) * C <= k; ++ci) acc += cnt[ci];
+
+                    i64 r = acc;
+                    for (i64 i = ci * C / 64; i < k / 64; ++i) r += popcnt(w[i]);
+                    if (k % 64 != 0) r += popcnt(w[k / 64] & ((u64(1) << (k % 64)) - 1));
+
+                    return r;
+                };
+
+                i64 s = 0, ms = 0;
+                if (p * p <= y) {
+                    for (i64 &m = nx[b]; m > y / p; --m) {
+                        if (mu[m] == 0 || sv.lp[m] <= p) continue;
+
+                        const i64 v = x / (p * m);
+                        if (v >= hi) break;
+
+                        s -= mu[m] * count(v);
+                        ms -= mu[m];
+                    }
+                } else {
+                    for (i64 &k = nx[b]; k >= b; --k) {
+                        const i64 v = x / (p * static_cast<i64>(ps[k]));
+                        if (v >= hi) break;
+
+                        s += count(v);
+                        ++ms;
+                    }
+                }
+
+                sum[j] += s + ms * phi[b];
+                wsum[b] += ms;
+                phi[b] += alive;
+
+                if (b == B) break;
+
+                // Remove the odd multiples of p_b, p_b itself included
+                i64 f = std::max(p, (lo + p) / p * p);
+                if (f % 2 == 0) f += p;
+
+                for (i64 i = (f - lo - 1) / 2; i < L; i += p) {
+                    const i32 d = static_cast<i32>((w[i / 64] >> (i % 64)) & 1);
+                    cnt[i / C] -= d;
+                    alive -= d;
+                    w[i / 64] &= ~(u64(1) << (i % 64));
+                }
+            }
+        }
+    });
+
+    std::vector<i64> pre(B + 1);
+    for (i32 j = 0; j < t; ++j) {
+        res += sum[j];
+        for (i32 b = 2; b <= B; ++b) {
+            res += ws[j][b] * pre[b];
+            pre[b] += cs[j][b];
+        }
+    }
+
+    return res;
+}
+
+#endif // LIB_PRIME_COUNT_DR_HPP
@@ -0,0 +1,38 @@
+#ifndef LIB_PRIME_SUM_HPP
+#define LIB_PRIME_SUM_HPP 1
+
+#include <vector>
+
+#include <lib/enumerate_quotients.hpp>
+#include <lib/numeric_traits.hpp>
+#include <lib/prelude.hpp>
+
+// s[i] = sum of f(p) over primes p <= qs[i], where qs = enumerate_quotients(n)
+// f must be completely multiplicative and sf(v) = f(2) + f(3) + ... + f(v)
+// e.g. f(k) = 1 gives pi(n / i) and f(k) = k gives sums of primes, in O(n^(3/4))
+template <typename T, typename U, typename F, typename G, is_unsigned_integral_t<U> * = nullptr>
+std::vector<T> prime_sum(U n, F f, G sf) {
+    const auto qs = enumerate_quotients(n);
+    const usize sz = qs.size();
+
+    usize m = 0;
+    while (m < sz && qs[m] == m + 1) ++m;
+
+    const auto idx = [&](U v) -> usize { return v <= m ? v - 1 : sz - n / v; };
+
+    std::vector<T> s(sz);
+    for (usize i = 0; i < sz; ++i) s[i] = sf(qs[i]);
+
+    std::vector<bool> comp(m + 1);
+    for (U p = 2; p * p <= n; ++p) {
+        if (comp[p]) continue;
+        for (U j = p * p; j <= m; j += p) comp[j] = true;
+
+        const T fp = f(p), sp = s[p - 2];
+        for (usize i = sz; i-- > 0 && qs[i] >= p * p;) s[i] -= fp * (s[idx(qs[i] / p)] - sp);
+    }
+
+    return s;
+}
+
+#endif // LIB_PRIME_SUM_HPP
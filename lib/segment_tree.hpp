@@ -1,10 +1,13 @@
 #ifndef LIB_SEGMENT_TREE_HPP
 #define LIB_SEGMENT_TREE_HPP 1
 
+#include <algorithm>
 #include <cassert>
+#include <span>
 #include <vector>
 
 #include <lib/algebraic_traits.hpp>
+#include <lib/batch_operation.hpp>
 #include <lib/prelude.hpp>
 
 template <typename Monoid, is_monoid_t<Monoid> * = nullptr>
@@ -97,6 +100,49 @@ struct segment_tree {
         return d[1];
     }
 
+    // Runs ops in order and returns the results of the prods
+    // Every maximal run of updates is written to the leaves in order and the touched nodes are
+    // then recomputed level by level, each once: all of them if the run is long, like build,
+    // otherwise the sorted parents of the touched leaves
+    std::vector<X> batch(std::span<const batch_operation<X>> ops) {
+        std::vector<X> res;
+        std::vector<i32> idx;
+
+        for (usize s = 0, e = 0; s < ops.size(); s = e) {
+            for (; e < ops.size() && ops[e].type != batch_op::prod; ++e) {
+                const auto &o = ops[e];
+                assert(0 <= o.l && o.l < n);
+
+                X &y = d[size + o.l];
+                y = o.type == batch_op::set ? o.x : MX::op(y, o.x);
+            }
+
+            if (static_cast<i64>(e - s) * log >= size) {
+                for (i32 i = size - 1; i >= 1; --i) update(i);
+            } else if (e > s) {
+                idx.clear();
+                for (usize i = s; i < e; ++i) idx.push_back((size + ops[i].l) >> 1);
+
+                std::sort(idx.begin(), idx.end());
+                idx.erase(std::unique(idx.begin(), idx.end()), idx.end());
+
+                while (!idx.empty()) {
+                    i32 m = 0;
+                    for (const i32 i : idx) {
+                        update(i);
+                        if (i > 1 && (m == 0 || idx[m - 1] != i >> 1)) idx[m++] = i >> 1;
+                    }
+
+                    idx.resize(m);
+                }
+            }
+
+            for (; e < ops.size() && ops[e].type == batch_op::prod; ++e) res.push_back(prod(ops[e].l, ops[e].r));
+        }
+
+        return res;
+    }
+
     template <typename F>
     i32 max_right(F f, i32 l) const {
         assert(0 <= l && l <= n && f(MX::unit()));
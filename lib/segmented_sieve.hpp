@@ -0,0 +1,196 @@
+#ifndef LIB_SEGMENTED_SIEVE_HPP
+#define LIB_SEGMENTED_SIEVE_HPP 1
+
+#include <algorithm>
+#include <barrier>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <lib/bits.hpp>
+#include <lib/parallel.hpp>
+#include <lib/prelude.hpp>
+
+// Sieve of Eratosthenes over [L, R) for R <= n, without any table of size R
+// Only odd numbers are stored, one bit each, in blocks of S bits (32 KiB, one L1 cache)
+// Blocks are independent and can be sieved on several threads
+struct segmented_sieve {
+    static constexpr u64 S = u64(1) << 18;
+    static constexpr u64 W = S / 64;
+
+    // Multiples of 3, 5, 7, 11, 13 repeat every P odd numbers and are copied in from a pattern
+    static constexpr u64 P = 3 * 5 * 7 * 11 * 13;
+    static constexpr i32 K = 5;
+
+    u64 n;
+    std::vector<u32> pr;
+    std::vector<u64> pat;
+
+    segmented_sieve() {}
+    explicit segmented_sieve(u64 m) {
+        build(m);
+    }
+
+    // Odd primes up to sqrt(m)
+    void build(u64 m) {
+        n = m;
+
+        u64 r = static_cast<u64>(std::sqrt(static_cast<double>(n)));
+        while (r * r > n) --r;
+        while ((r + 1) * (r + 1) <= n) ++r;
+
+        std::vector<bool> c(r + 1);
+
+        pr.clear();
+        for (u64 i = 3; i <= r; i += 2) {
+            if (c[i]) continue;
+
+            pr.push_back(static_cast<u32>(i));
+            for (u64 j = i * i; j <= r; j += 2 * i) c[j] = true;
+        }
+
+        // Bit i is set iff 2i + 1 is coprime to P, for i < P + 128
+        pat.assign((P + 128) / 64 + 1, 0);
+        for (u64 i = 0; i < P + 128; ++i) {
+            const u64 x = 2 * (i % P) + 1;
+            if (x % 3 && x % 5 && x % 7 && x % 11 && x % 13) pat[i / 64] |= u64(1) << (i % 64);
+        }
+    }
+
+    // Bit i of w is set iff lo + 2i is an odd prime, for i < k; lo must be odd and lo + 2k <= n + 2
+    void sieve_block(u64 lo, u64 k, u64 *w) const {
+        assert(lo % 2 == 1);
+
+        const u64 m = (k + 63) / 64;
+        for (u64 j = 0, o = (lo / 2) % P; j < m; ++j) {
+            w[j] = o % 64 == 0 ? pat[o / 64] : (pat[o / 64] >> (o % 64)) | (pat[o / 64 + 1] << (64 - o % 64));
+            if ((o += 64) >= P) o -= P;
+        }
+
+        if (k % 64 != 0) w[m - 1] &= (u64(1) << (k % 64)) - 1;
+        if (lo == 1) w[0] &= ~u64(1);
+
+        // The pattern also removed the small primes themselves
+        for (const u64 p : {3, 5, 7, 11, 13})
+            if (lo <= p && p < lo + 2 * k) w[(p - lo) / 128] |= u64(1) << ((p - lo) / 2 % 64);
+
+        const u64 hi = lo + 2 * k;
+        for (usize x = K; x < pr.size(); ++x) {
+            const u64 p = pr[x];
+            if (p * p >= hi) break;
+
+            u64 s = std::max(p * p, (lo + p - 1) / p * p);
+            if (s % 2 == 0) s += p;
+
+            for (u64 i = (s - lo) / 2; i < k; i += p) w[i / 64] &= ~(u64(1) << (i % 64));
+        }
+    }
+
+    // Calls f(p) for every prime p in [L, R) in increasing order
+    // With t > 1, t workers are started once per call and sieve rounds of 4t blocks into one half of
+    // a double buffer while the calling thread scans the previous round from the other half and
+    // calls f; a barrier per round hands the halves over, no thread is created per round
+    template <typename F>
+    void enumerate(u64 L, u64 R, F f, i32 t = 1) const {
+        assert(R <= n + 1);
+
+        if (L <= 2 && 2 < R) f(u64(2));
+
+        const u64 lo = L | 1;
+        if (lo >= R) return;
+
+        const u64 k = (R - lo + 1) / 2;
+        const u64 blocks = (k + S - 1) / S;
+
+        t = static_cast<i32>(std::min<u64>(std::max(t, 1), blocks));
+        const u64 per = static_cast<u64>(t) * 4;
+        const u64 rounds = (blocks + per - 1) / per;
+
+        std::vector<u64> w(2 * per * W);
+        const auto buffer = [&](u64 r) { return w.data() + (r % 2) * per * W; };
+
+        const auto sieve = [&](u64 r, u64 j, u64 step) {
+            for (u64 i = j, b0 = r * per; i < per && b0 + i < blocks; i += step) {
+                const u64 b = b0 + i;
+                sieve_block(lo + 2 * b * S, std::min(S, k - b * S), buffer(r) + i * W);
+            }
+        };
+
+        const auto scan = [&](u64 r) {
+            for (u64 i = 0, b0 = r * per; i < per && b0 + i < blocks; ++i) {
+                const u64 base = lo + 2 * (b0 + i) * S;
+                const u64 *x = buffer(r) + i * W;
+                const u64 m = (std::min(S, k - (b0 + i) * S) + 63) / 64;
+
+                for (u64 j = 0; j < m; ++j)
+                    for (u64 y = x[j]; y != 0; y &= y - 1) f(base + 2 * (64 * j + lowbit(y)));
+            }
+        };
+
+        if (t == 1) {
+            for (u64 r = 0; r < rounds; ++r) {
+                sieve(r, 0, 1);
+                scan(r);
+            }
+
+            return;
+        }
+
+        // Phase r ends once round r is sieved and round r - 1 is scanned, which frees its half
+        std::barrier sync(t + 1);
+        std::vector<std::thread> ths;
+        for (i32 j = 0; j < t; ++j)
+            ths.emplace_back([&, j]() {
+                for (u64 r = 0; r < rounds; ++r) {
+                    sieve(r, static_cast<u64>(j), static_cast<u64>(t));
+                    sync.arrive_and_wait();
+                }
+            });
+
+        for (u64 r = 0; r < rounds; ++r) {
+            sync.arrive_and_wait();
+            scan(r);
+        }
+
+        for (auto &&th : ths) th.join();
+    }
+
+    // Number of primes in [L, R), fully parallel
+    u64 count(u64 L, u64 R, i32 t = 1) const {
+        assert(R <= n + 1);
+
+        u64 c = L <= 2 && 2 < R;
+
+        const u64 lo = L | 1;
+        if (lo >= R) return c;
+
+        const u64 k = (R - lo + 1) / 2;
+        const u64 blocks = (k + S - 1) / S;
+
+        t = std::max(t, 1);
+        std::vector<std::vector<u64>> w(t);
+        std::vector<u64> cs(t);
+
+        parallel_for(t, blocks, [&](u64 b, i32 j) {
+            if (w[j].empty()) w[j].resize(W);
+
+            const u64 m = std::min(S, k - b * S);
+            sieve_block(lo + 2 * b * S, m, w[j].data());
+
+            for (u64 i = 0; i < (m + 63) / 64; ++i) cs[j] += popcnt(w[j][i]);
+        });
+
+        for (const u64 x : cs) c += x;
+        return c;
+    }
+
+    std::vector<u64> primes(u64 L, u64 R, i32 t = 1) const {
+        std::vector<u64> ps;
+        enumerate(L, R, [&](u64 p) { ps.push_back(p); }, t);
+
+        return ps;
+    }
+};
+
+#endif // LIB_SEGMENTED_SIEVE_HPP
@@ -0,0 +1,255 @@
+#ifndef LIB_SERIALIZE_HPP
+#define LIB_SERIALIZE_HPP 1
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <lib/prelude.hpp>
+
+// Flat format for static structures: a header (magic, version, structure tag) and then the
+// fields in order, every one padded to a multiple of 8 bytes
+// An array is its length and element size followed by the raw elements, so that a mapped file
+// can hand out spans into itself; structures store the native (little-endian) representation
+// Structures provide `save(Writer &)` and `bool load(Reader &)` with a SERIAL_TAG, plain arrays
+// such as suffix_array and lcp_array are written and read directly with array()
+// A load returns false unless its fields agree with each other (lengths, levels, indices), so
+// that queries on a structure loaded from a corrupt file stay in bounds
+constexpr u64 SERIAL_MAGIC = 0x0042494c4b47484e; // "NHGKLIB"
+constexpr u32 SERIAL_VERSION = 2;
+
+// Raw bytes of T are its value: trivially copyable, or a standard layout type such as std::pair
+template <typename T>
+constexpr bool is_serial_trivial_v =
+    std::is_trivially_copyable_v<T> || (std::is_standard_layout_v<T> && std::is_trivially_destructible_v<T>);
+
+struct serial_writer {
+    std::ostream &os;
+
+    explicit serial_writer(std::ostream &s)
+        : os(s) {}
+
+    void bytes(const void *p, usize k) {
+        static constexpr char zero[8]{};
+        os.write(static_cast<const char *>(p), static_cast<std::streamsize>(k));
+        os.write(zero, static_cast<std::streamsize>(-k & 7));
+    }
+
+    void header(u32 tag) {
+        const u64 h[2] = {SERIAL_MAGIC, u64(tag) << 32 | SERIAL_VERSION};
+        bytes(h, sizeof(h));
+    }
+
+    template <typename T>
+    void value(const T &x) {
+        static_assert(is_serial_trivial_v<T>);
+        bytes(&x, sizeof(T));
+    }
+
+    template <typename T>
+    void array(std::span<const T> a) {
+        static_assert(is_serial_trivial_v<T> && alignof(T) <= 8);
+
+        const u64 h[2] = {a.size(), sizeof(T)};
+        bytes(h, sizeof(h));
+        bytes(a.data(), a.size_bytes());
+    }
+
+    template <typename T>
+    void array(const std::vector<T> &a) {
+        array(std::span<const T>(a));
+    }
+};
+
+// Reads from a stream into owned storage; every read returns false on malformed input
+// The stream cannot tell how much is left, so arrays are read in chunks of at most C bytes and a
+// corrupt length fails at the end of the stream instead of allocating it all up front
+struct serial_reader {
+    static constexpr u64 C = u64(1) << 20;
+
+    std::istream &is;
+
+    explicit serial_reader(std::istream &s)
+        : is(s) {}
+
+    bool bytes(void *p, usize k) {
+        char pad[8];
+        return is.read(static_cast<char *>(p), static_cast<std::streamsize>(k)) &&
+               is.read(pad, static_cast<std::streamsize>(-k & 7));
+    }
+
+    bool header(u32 tag) {
+        u64 h[2];
+        return bytes(h, sizeof(h)) && h[0] == SERIAL_MAGIC && h[1] == (u64(tag) << 32 | SERIAL_VERSION);
+    }
+
+    template <typename T>
+    bool value(T &x) {
+        static_assert(is_serial_trivial_v<T>);
+        return bytes(&x, sizeof(T));
+    }
+
+    template <typename T>
+    bool array(std::vector<T> &a) {
+        static_assert(is_serial_trivial_v<T> && alignof(T) <= 8);
+
+        u64 h[2];
+        if (!bytes(h, sizeof(h)) || h[1] != sizeof(T) || h[0] > a.max_size()) return false;
+
+        a.clear();
+        for (u64 i = 0; i < h[0];) {
+            const u64 k = std::min(C / sizeof(T) + 1, h[0] - i);
+            a.resize(i + k);
+
+            if (!is.read(reinterpret_cast<char *>(a.data() + i), static_cast<std::streamsize>(k * sizeof(T)))) return false;
+            i += k;
+        }
+
+        char pad[8];
+        return static_cast<bool>(is.read(pad, static_cast<std::streamsize>(-(h[0] * sizeof(T)) & 7)));
+    }
+};
+
+// Reads from memory, usually a mapped_file; arrays can be taken as spans into it without a copy
+struct serial_view {
+    const u8 *p, *e;
+
+    serial_view(const void *d, usize k)
+        : p(static_cast<const u8 *>(d)), e(p + k) {
+        assert(reinterpret_cast<usize>(d) % 8 == 0);
+    }
+
+    const u8 *take(usize k) {
+        k = (k + 7) & ~usize(7);
+        if (static_cast<usize>(e - p) < k) return nullptr;
+
+        return std::exchange(p, p + k);
+    }
+
+    bool bytes(void *q, usize k) {
+        const u8 *s = take(k);
+        if (s == nullptr) return false;
+
+        std::memcpy(q, s, k);
+        return true;
+    }
+
+    bool header(u32 tag) {
+        u64 h[2];
+        return bytes(h, sizeof(h)) && h[0] == SERIAL_MAGIC && h[1] == (u64(tag) << 32 | SERIAL_VERSION);
+    }
+
+    template <typename T>
+    bool value(T &x) {
+        static_assert(is_serial_trivial_v<T>);
+        return bytes(&x, sizeof(T));
+    }
+
+    template <typename T>
+    bool array(std::span<const T> &a) {
+        static_assert(is_serial_trivial_v<T> && alignof(T) <= 8);
+
+        u64 h[2];
+        if (!bytes(h, sizeof(h)) || h[1] != sizeof(T) || h[0] > static_cast<usize>(e - p) / sizeof(T)) return false;
+
+        // The length fits, but the padding after the elements may still be cut off
+        const u8 *q = take(h[0] * sizeof(T));
+        if (q == nullptr) return false;
+
+        a = {reinterpret_cast<const T *>(q), h[0]};
+        return true;
+    }
+
+    template <typename T>
+    bool array(std::vector<T> &a) {
+        std::span<const T> s;
+        if (!array(s)) return false;
+
+        a.assign(s.begin(), s.end());
+        return true;
+    }
+};
+
+// A whole file mapped read-only, unmapped on destruction
+struct mapped_file {
+    void *d = nullptr;
+    usize sz = 0;
+
+    mapped_file() {}
+    explicit mapped_file(const char *path) {
+        open(path);
+    }
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    mapped_file(mapped_file &&o) noexcept
+        : d(std::exchange(o.d, nullptr)), sz(std::exchange(o.sz, 0)) {}
+
+    mapped_file &operator=(mapped_file &&o) noexcept {
+        close();
+        d = std::exchange(o.d, nullptr);
+        sz = std::exchange(o.sz, 0);
+        return *this;
+    }
+
+    ~mapped_file() {
+        close();
+    }
+
+    bool open(const char *path) {
+        close();
+
+        const i32 fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *q = ::mmap(nullptr, static_cast<usize>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (q != MAP_FAILED) {
+                d = q;
+                sz = static_cast<usize>(st.st_size);
+            }
+        }
+
+        ::close(fd);
+        return d != nullptr;
+    }
+
+    void close() {
+        if (d != nullptr) ::munmap(d, sz);
+
+        d = nullptr;
+        sz = 0;
+    }
+
+    serial_view view() const {
+        return serial_view(d, sz);
+    }
+};
+
+template <typename S>
+void serialize(std::ostream &os, const S &x) {
+    serial_writer w(os);
+    w.header(S::SERIAL_TAG);
+    x.save(w);
+}
+
+// Reader is a serial_reader or a serial_view
+template <typename S, typename Reader>
+bool deserialize(Reader &r, S &x) {
+    return r.header(S::SERIAL_TAG) && x.load(r);
+}
+
+#endif // LIB_SERIALIZE_HPP
@@ -1,13 +1,20 @@
 #ifndef LIB_SIEVE_HPP
 #define LIB_SIEVE_HPP 1
 
+#include <array>
 #include <cassert>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 #include <lib/prelude.hpp>
 
 struct sieve {
+    // No i32 has more distinct prime factors
+    static constexpr i32 MAX_FACTORS = 9;
+
+    using factorization = std::array<std::pair<i32, i32>, MAX_FACTORS>;
+
     i32 n;
     std::vector<i32> lp, pr;
 
@@ -59,6 +66,26 @@ struct sieve {
         return f;
     }
 
+    // Writes the factorization of k to f and returns the number of distinct primes
+    i32 factorize(i32 k, factorization &f) const {
+        assert(0 < k && k <= n);
+
+        i32 m = 0;
+        while (k != 1) {
+            const i32 p = lp[k];
+
+            i32 c = 0;
+            do {
+                k /= p;
+                ++c;
+            } while (k % p == 0);
+
+            f[m++] = {p, c};
+        }
+
+        return m;
+    }
+
     i32 totient(i32 k) const {
         assert(k <= n);
 
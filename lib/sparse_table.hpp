@@ -13,6 +13,8 @@ struct sparse_table {
     using MX = Monoid;
     using X = typename MX::ValueT;
 
+    static constexpr u32 SERIAL_TAG = 0x42545053; // "SPTB"
+
     i32 n, log;
     std::vector<std::vector<X>> d;
 
@@ -53,6 +55,39 @@ struct sparse_table {
         }
     }
 
+    // See serialize.hpp
+    template <typename Writer>
+    void save(Writer &w) const {
+        w.value(n);
+        w.value(log);
+        for (const auto &x : d) w.array(x);
+    }
+
+    template <typename Reader>
+    bool load(Reader &r) {
+        if (!(r.value(n) && r.value(log)) || n < 0) return false;
+
+        i32 k = 1;
+        while ((i64(1) << k) < n) ++k;
+        if (log != k) return false;
+
+        // Level i holds n - 2^i + 1 products, as built
+        d.resize(log);
+        for (i32 i = 0; i < log; ++i)
+            if (!r.array(d[i]) || static_cast<i64>(d[i].size()) != i64(n) - (1 << i) + 1) return false;
+
+        return true;
+    }
+
+    // Pulls in the lines a prod(l, r) reads
+    void prefetch(i32 l, i32 r) const {
+        if (r - l < 2) return;
+
+        const i32 k = static_cast<i32>(topbit(r - l - 1));
+        __builtin_prefetch(&d[k][l]);
+        __builtin_prefetch(&d[k][r - (1 << k)]);
+    }
+
     X get(i32 p) const {
         assert(0 <= p && p < n);
 
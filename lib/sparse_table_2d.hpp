@@ -1,21 +1,29 @@
 #ifndef LIB_SPARSE_TABLE_2D_HPP
 #define LIB_SPARSE_TABLE_2D_HPP 1
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
 #include <vector>
 
 #include <lib/algebraic_traits.hpp>
+#include <lib/aligned_allocator.hpp>
 #include <lib/bits.hpp>
 #include <lib/prelude.hpp>
-#include <lib/sparse_table.hpp>
 
+// Level (a, b) holds the products of the 2^a x 2^b rectangles as an H x S row-major grid, with the
+// row stride S padded to whole cache lines; the levels follow each other in one allocation, so a
+// query is four loads from one level
 template <typename Monoid, is_commutative_monoid_t<Monoid> * = nullptr>
 struct sparse_table_2d {
     using MX = Monoid;
     using X = typename MX::ValueT;
 
-    i32 H, W;
-    std::vector<std::vector<sparse_table<Monoid>>> d;
+    static constexpr usize L = 64 / std::gcd<usize>(64, sizeof(X));
+
+    i32 H, W, LH, LW;
+    usize S;
+    std::vector<X, aligned_allocator<X>> d;
 
     sparse_table_2d() {}
 
@@ -32,6 +40,10 @@ struct sparse_table_2d {
         build(h, w, f);
     }
 
+    void build(i32 h, i32 w) {
+        build(h, w, [](i32, i32) -> X { return MX::unit(); });
+    }
+
     void build(const std::vector<std::vector<X>> &v) {
         const i32 h = static_cast<i32>(v.size());
         const i32 w = static_cast<i32>(v[0].size());
@@ -43,20 +55,39 @@ struct sparse_table_2d {
     void build(i32 h, i32 w, F f) {
         H = h;
         W = w;
+        LH = H > 0 ? static_cast<i32>(topbit(H)) + 1 : 0;
+        LW = W > 0 ? static_cast<i32>(topbit(W)) + 1 : 0;
+        S = (static_cast<usize>(W) + L - 1) / L * L;
+
+        d.assign(static_cast<usize>(LH) * LW * H * S, MX::unit());
+        if (H == 0 || W == 0) return;
+
+        for (i32 i = 0; i < H; ++i)
+            for (i32 j = 0; j < W; ++j) d[i * S + j] = f(i, j);
+
+        // Every level comes from the one below it by combining two rows (or two shifted copies of
+        // one row) element by element
+        for (i32 b = 0; b + 1 < LW; ++b) {
+            const i32 m = W - (2 << b) + 1;
+            for (i32 i = 0; i < H; ++i) {
+                const X *x = level(0, b) + i * S;
+                X *y = level(0, b + 1) + i * S;
+
+                for (i32 j = 0; j < m; ++j) y[j] = MX::op(x[j], x[j + (1 << b)]);
+            }
+        }
 
-        i32 log = 1;
-        while ((1 << log) < h) ++log;
-        d.resize(log);
-
-        d[0].resize(h);
-        for (i32 i = 0; i < h; ++i) d[0][i].build(w, [&](i32 j) -> X { return f(i, j); });
-
-        for (i32 i = 0; i < log - 1; ++i) {
-            const i32 k = static_cast<i32>(d[i].size()) - (1 << i);
-
-            d[i + 1].resize(k);
-            for (i32 j = 0; j < k; ++j)
-                d[i + 1][j].build(w, [&](i32 p) -> X { return MX::op(d[i][j].d[0][p], d[i][j + (1 << i)].d[0][p]); });
+        for (i32 a = 0; a + 1 < LH; ++a) {
+            for (i32 b = 0; b < LW; ++b) {
+                const i32 m = W - (1 << b) + 1;
+                for (i32 i = 0; i + (2 << a) <= H; ++i) {
+                    const X *x = level(a, b) + i * S;
+                    const X *z = level(a, b) + (i + (1 << a)) * S;
+                    X *y = level(a + 1, b) + i * S;
+
+                    for (i32 j = 0; j < m; ++j) y[j] = MX::op(x[j], z[j]);
+                }
+            }
         }
     }
 
@@ -64,11 +95,22 @@ struct sparse_table_2d {
         assert(0 <= xl && xl <= xr && xr <= H);
         assert(0 <= yl && yl <= yr && yr <= W);
 
-        if (xl == xr) return MX::unit();
-        if (xl + 1 == xr) return d[0][xl].prod(yl, yr);
+        if (xl == xr || yl == yr) return MX::unit();
+
+        const i32 a = static_cast<i32>(topbit(xr - xl)), b = static_cast<i32>(topbit(yr - yl));
+        const X *u = level(a, b) + xl * S, *v = level(a, b) + (xr - (1 << a)) * S;
+
+        const i32 yr2 = yr - (1 << b);
+        return MX::op(MX::op(u[yl], u[yr2]), MX::op(v[yl], v[yr2]));
+    }
+
+private:
+    const X *level(i32 a, i32 b) const {
+        return d.data() + (static_cast<usize>(a) * LW + b) * H * S;
+    }
 
-        const i32 k = topbit(xr - xl - 1);
-        return MX::op(d[k][xl].prod(yl, yr), d[k][xr - (1 << k)].prod(yl, yr));
+    X *level(i32 a, i32 b) {
+        return d.data() + (static_cast<usize>(a) * LW + b) * H * S;
     }
 };
 
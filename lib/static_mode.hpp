@@ -7,8 +7,10 @@
 #include <vector>
 
 #include <lib/prelude.hpp>
+#include <lib/static_search.hpp>
 
-template <typename T>
+// Search is sorted_search or eytzinger_search, used to compress the values
+template <typename T, typename Search = sorted_search<T>>
 struct static_mode {
     i32 n, sq;
     std::vector<T> cmp;
@@ -36,9 +38,12 @@ struct static_mode {
         std::sort(cmp.begin(), cmp.end());
         cmp.erase(std::unique(cmp.begin(), cmp.end()), cmp.end());
 
+        Search sr;
+        sr.build(cmp);
+        sr.lower_bound_many(cmp, v, val);
+
         for (i32 i = 0; i < n; i++) {
-            const i32 id = static_cast<i32>(std::lower_bound(cmp.begin(), cmp.end(), v[i]) - cmp.begin());
-            val[i] = id;
+            const i32 id = val[i];
             rank[i] = static_cast<i32>(pos[id].size());
             pos[id].push_back(i);
         }
@@ -12,6 +12,8 @@ struct static_product {
     using MX = Monoid;
     using X = typename MX::ValueT;
 
+    static constexpr u32 SERIAL_TAG = 0x52505453; // "STPR"
+
     i32 n;
     std::vector<X> d;
 
@@ -41,6 +43,18 @@ struct static_product {
         for (i32 i = 0; i < n; ++i) d[i + 1] = MX::op(d[i], f(i));
     }
 
+    // See serialize.hpp
+    template <typename Writer>
+    void save(Writer &w) const {
+        w.value(n);
+        w.array(d);
+    }
+
+    template <typename Reader>
+    bool load(Reader &r) {
+        return r.value(n) && n >= 0 && r.array(d) && static_cast<i64>(d.size()) == i64(n) + 1;
+    }
+
     X get(i32 p) const {
         assert(0 <= p && p < n);
 
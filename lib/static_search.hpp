@@ -0,0 +1,141 @@
+#ifndef LIB_STATIC_SEARCH_HPP
+#define LIB_STATIC_SEARCH_HPP 1
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <lib/aligned_allocator.hpp>
+#include <lib/prelude.hpp>
+
+// Search layers over a sorted array a, as used by wavelet_matrix, lichao_tree and static_mode:
+// build(a) once, then lower_bound(a, x) / upper_bound(a, x) return the same index as the std ones
+
+// Plain binary search on a itself, nothing extra stored
+template <typename T>
+struct sorted_search {
+    void build(const std::vector<T> &) {}
+
+    i32 lower_bound(const std::vector<T> &a, const T &x) const {
+        return static_cast<i32>(std::lower_bound(a.begin(), a.end(), x) - a.begin());
+    }
+
+    i32 upper_bound(const std::vector<T> &a, const T &x) const {
+        return static_cast<i32>(std::upper_bound(a.begin(), a.end(), x) - a.begin());
+    }
+
+    void lower_bound_many(const std::vector<T> &a, std::span<const T> xs, std::span<i32> res) const {
+        for (usize i = 0; i < xs.size(); ++i) res[i] = lower_bound(a, xs[i]);
+    }
+};
+
+// A copy of a in Eytzinger (BFS) order: node k has children 2k and 2k + 1, so the first levels
+// share cache lines and the descent is branchless, prefetching at node k the line of its B
+// descendants k B, ..., k B + B - 1, which lie log2(B) levels down (four for 4-byte T, three for
+// 8-byte T, none once T fills a line); t starts on a cache line, so when sizeof(T) divides 64
+// those descendants share one line
+// Can be used on its own, the a parameters are only there to match sorted_search
+template <typename T>
+struct eytzinger_search {
+    static constexpr usize B = std::max<usize>(1, 64 / sizeof(T));
+
+    i32 n;
+    std::vector<T, aligned_allocator<T>> t;
+    std::vector<i32> rk;
+
+    eytzinger_search() {}
+    explicit eytzinger_search(const std::vector<T> &a) {
+        build(a);
+    }
+
+    void build(const std::vector<T> &a) {
+        n = static_cast<i32>(a.size());
+        t.assign(n + 1, T{});
+
+        // rk[k] is the index in a of node k, rk[0] = n stands for past the end
+        rk.assign(n + 1, n);
+
+        i32 i = 0;
+        const auto dfs = [&](auto &&self, i32 k) -> void {
+            if (k > n) return;
+
+            self(self, 2 * k);
+            t[k] = a[i];
+            rk[k] = i++;
+            self(self, 2 * k + 1);
+        };
+
+        dfs(dfs, 1);
+    }
+
+    // The descent goes right past every node < x; the answer is the last node it went left at,
+    // found by dropping the trailing right turns and the left turn before them
+    i32 lower_bound(const T &x) const {
+        usize k = 1;
+        while (k <= static_cast<usize>(n)) {
+            prefetch(k);
+            k = 2 * k + (t[k] < x);
+        }
+
+        return rk[k >> (std::countr_one(k) + 1)];
+    }
+
+    i32 upper_bound(const T &x) const {
+        usize k = 1;
+        while (k <= static_cast<usize>(n)) {
+            prefetch(k);
+            k = 2 * k + !(x < t[k]);
+        }
+
+        return rk[k >> (std::countr_one(k) + 1)];
+    }
+
+    // res[i] := lower_bound(xs[i]), with groups of G descents interleaved level by level so that
+    // their cache misses overlap
+    void lower_bound_many(std::span<const T> xs, std::span<i32> res) const {
+        constexpr usize G = 32;
+
+        const i32 h = static_cast<i32>(std::bit_width(static_cast<u32>(n)));
+        for (usize s = 0; s < xs.size(); s += G) {
+            const usize g = std::min(G, xs.size() - s);
+
+            std::array<usize, G> k;
+            k.fill(1);
+
+            for (i32 d = 0; d < h; ++d) {
+                for (usize j = 0; j < g; ++j) {
+                    if (k[j] > static_cast<usize>(n)) continue;
+
+                    prefetch(k[j]);
+                    k[j] = 2 * k[j] + (t[k[j]] < xs[s + j]);
+                }
+            }
+
+            for (usize j = 0; j < g; ++j) res[s + j] = rk[k[j] >> (std::countr_one(k[j]) + 1)];
+        }
+    }
+
+    i32 lower_bound(const std::vector<T> &, const T &x) const {
+        return lower_bound(x);
+    }
+
+    i32 upper_bound(const std::vector<T> &, const T &x) const {
+        return upper_bound(x);
+    }
+
+    void lower_bound_many(const std::vector<T> &, std::span<const T> xs, std::span<i32> res) const {
+        lower_bound_many(xs, res);
+    }
+
+private:
+    // The address is computed as an integer: on the last levels it is past the end of t, where a
+    // pointer could not be formed, and a prefetch never faults; clamping it costs a third per query
+    void prefetch(usize k) const {
+        __builtin_prefetch(reinterpret_cast<const void *>(reinterpret_cast<std::uintptr_t>(t.data()) + k * B * sizeof(T)));
+    }
+};
+
+#endif // LIB_STATIC_SEARCH_HPP
@@ -0,0 +1,93 @@
+#ifndef LIB_SUBPRODUCT_TREE_HPP
+#define LIB_SUBPRODUCT_TREE_HPP 1
+
+#include <cassert>
+#include <vector>
+
+#include <lib/convolution_ntt.hpp>
+#include <lib/fps.hpp>
+#include <lib/prelude.hpp>
+
+template <typename Z>
+struct subproduct_tree {
+    static constexpr i32 THRESHOLD = 64;
+
+    i32 n, size;
+    std::vector<Z> xs;
+    std::vector<std::vector<Z>> t;
+
+    subproduct_tree() {}
+    explicit subproduct_tree(const std::vector<Z> &x) {
+        build(x);
+    }
+
+    void build(const std::vector<Z> &x) {
+        xs = x;
+        n = static_cast<i32>(xs.size());
+
+        size = 1;
+        while (size < n) size <<= 1;
+
+        t.assign(2 * size, {1});
+        for (i32 i = 0; i < n; ++i) t[size + i] = {-xs[i], 1};
+        for (i32 i = size - 1; i >= 1; --i) t[i] = convolution_ntt(t[2 * i], t[2 * i + 1]);
+    }
+
+    std::vector<Z> evaluate(const std::vector<Z> &f) const {
+        std::vector<Z> ys(n);
+        if (n == 0) return ys;
+
+        const auto dfs = [&](auto &&self, i32 k, i32 l, i32 r, std::vector<Z> g) -> void {
+            if (l >= n) return;
+
+            g = poly_divmod(std::move(g), t[k]).second;
+            if (r - l <= THRESHOLD) {
+                for (i32 i = l; i < std::min(r, n); ++i) {
+                    Z y = 0;
+                    for (i32 j = static_cast<i32>(g.size()); j-- > 0;) y = y * xs[i] + g[j];
+                    ys[i] = y;
+                }
+
+                return;
+            }
+
+            const i32 m = (l + r) / 2;
+            self(self, 2 * k, l, m, g);
+            self(self, 2 * k + 1, m, r, std::move(g));
+        };
+
+        dfs(dfs, 1, 0, size, f);
+        return ys;
+    }
+
+    // Polynomial of degree < n through (xs[i], ys[i]), xs must be distinct
+    std::vector<Z> interpolate(const std::vector<Z> &ys) const {
+        assert(static_cast<i32>(ys.size()) == n);
+        if (n == 0) return {};
+
+        auto w = evaluate(fps_derivative(t[1]));
+        for (i32 i = 0; i < n; ++i) w[i] = ys[i] / w[i];
+
+        const auto dfs = [&](auto &&self, i32 k, i32 l, i32 r) -> std::vector<Z> {
+            if (l >= n) return {};
+            if (r - l == 1) return {w[l]};
+
+            const i32 m = (l + r) / 2;
+
+            auto a = convolution_ntt(self(self, 2 * k, l, m), t[2 * k + 1]);
+            const auto b = convolution_ntt(self(self, 2 * k + 1, m, r), t[2 * k]);
+
+            if (a.size() < b.size()) a.resize(b.size());
+            for (i32 i = 0; i < static_cast<i32>(b.size()); ++i) a[i] += b[i];
+
+            return a;
+        };
+
+        auto f = dfs(dfs, 1, 0, size);
+        f.resize(n);
+
+        return f;
+    }
+};
+
+#endif // LIB_SUBPRODUCT_TREE_HPP
@@ -0,0 +1,173 @@
+#ifndef LIB_SUCCINCT_BIT_VECTOR_HPP
+#define LIB_SUCCINCT_BIT_VECTOR_HPP 1
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <lib/bits.hpp>
+#include <lib/prelude.hpp>
+
+// Drop-in replacement for bit_vector with about 6% extra space and select
+// Every 1024-bit block has one u64: the number of ones before it in the low 31 bits and the
+// number of ones before its second, third and fourth 256-bit sub-block in the next 3 x 10 bits,
+// so a rank reads one index word and at most four data words
+// The block of every S-th one (and zero) is sampled for select, which binary searches the blocks
+// between two samples
+struct succinct_bit_vector {
+    static constexpr i32 S = 1 << 13;
+    static constexpr u64 MASK = (u64(1) << 31) - 1;
+
+    i32 n;
+    std::vector<u64> d, b;
+    std::vector<i32> s0, s1;
+
+    explicit succinct_bit_vector(i32 m)
+        : n(m), d(((n + 1023) >> 10 << 4) + 1) {}
+
+    void set(i32 i) {
+        d[i >> 6] |= static_cast<u64>(1) << (i & 63);
+    }
+
+    void reset() {
+        d.assign(d.size(), 0);
+    }
+
+    // Ones before sub-block j of the block with index word e
+    static i32 sub(u64 e, i32 j) {
+        return static_cast<i32>((e >> (21 + 10 * j)) & 1023 & (0 - u64(j != 0)));
+    }
+
+    void build() {
+        const i32 m = static_cast<i32>(d.size() >> 4) + 1;
+        b.assign(m, 0);
+
+        u64 c = 0;
+        for (i32 i = 0; i < m; ++i) {
+            u64 e = c, t = 0;
+            for (i32 j = 0; j < 4; ++j) {
+                if (j > 0) e |= t << (21 + 10 * j);
+
+                for (i32 k = i << 4 | j << 2; k < (i << 4) + ((j + 1) << 2) && k < static_cast<i32>(d.size()); ++k)
+                    t += popcnt(d[k]);
+            }
+
+            b[i] = e;
+            c += t;
+        }
+
+        // Ones and zeros only count up to n, the padding is all zeros
+        s0.clear();
+        s1.clear();
+        for (i32 i = 0, o = 0, z = 0; i < m; ++i) {
+            const i32 c1 = i + 1 < m ? static_cast<i32>(b[i + 1] & MASK) : rank1(n);
+            const i32 c0 = std::min(n, (i + 1) << 10) - c1;
+
+            for (; o < c1; o += S) s1.push_back(i);
+            for (; z < c0; z += S) s0.push_back(i);
+        }
+    }
+
+    void prefetch(i32 i) const {
+        __builtin_prefetch(&b[i >> 10]);
+        __builtin_prefetch(&d[i >> 6]);
+    }
+
+    // Only the words are stored; the index and the samples are rebuilt on load, which is a single
+    // pass over the words and keeps select in bounds whatever the file holds
+    template <typename Writer>
+    void save(Writer &w) const {
+        w.value(n);
+        w.array(d);
+    }
+
+    template <typename Reader>
+    bool load(Reader &r) {
+        if (!(r.value(n) && n >= 0 && r.array(d) && static_cast<i64>(d.size()) == ((i64(n) + 1023) >> 10 << 4) + 1))
+            return false;
+
+        for (i32 i = n >> 6; i < static_cast<i32>(d.size()); ++i) d[i] &= i == n >> 6 ? (u64(1) << (n & 63)) - 1 : 0;
+
+        build();
+        return true;
+    }
+
+    bool operator[](i32 i) const {
+        return d[i >> 6] >> (i & 63) & 1;
+    }
+
+    i32 rank1(i32 r) const {
+        const u64 e = b[r >> 10];
+
+        i32 c = static_cast<i32>(e & MASK) + sub(e, (r >> 8) & 3);
+        for (i32 i = r >> 8 << 2; i < r >> 6; ++i) c += static_cast<i32>(popcnt(d[i]));
+
+        return c + static_cast<i32>(popcnt(d[r >> 6] & ((static_cast<u64>(1) << (r & 63)) - 1)));
+    }
+
+    i32 rank0(i32 r) const {
+        return r - rank1(r);
+    }
+
+    i32 rank1(i32 l, i32 r) const {
+        return rank1(r) - rank1(l);
+    }
+
+    i32 rank0(i32 l, i32 r) const {
+        return rank0(r) - rank0(l);
+    }
+
+    // Position of the k-th (0-indexed) one
+    i32 select1(i32 k) const {
+        return select<true>(k);
+    }
+
+    // Position of the k-th (0-indexed) zero
+    i32 select0(i32 k) const {
+        return select<false>(k);
+    }
+
+    template <bool one>
+    i32 select(i32 k) const {
+        const auto &s = one ? s1 : s0;
+        assert(0 <= k && k / S < static_cast<i32>(s.size()));
+
+        // Ones (or zeros) before block i and before sub-block j of it
+        const auto block = [&](i32 i) -> i32 {
+            const i32 c = static_cast<i32>(b[i] & MASK);
+            return one ? c : (i << 10) - c;
+        };
+
+        const auto inner = [&](i32 i, i32 j) -> i32 {
+            const i32 c = sub(b[i], j);
+            return one ? c : (j << 8) - c;
+        };
+
+        // The last block with block(i) <= k lies between the samples of k / S and k / S + 1
+        i32 i = s[k / S];
+        i32 hi = k / S + 1 < static_cast<i32>(s.size()) ? s[k / S + 1] + 1 : static_cast<i32>(b.size());
+        while (hi - i > 1) {
+            const i32 mid = (i + hi) >> 1;
+            if (block(mid) <= k)
+                i = mid;
+            else
+                hi = mid;
+        }
+
+        k -= block(i);
+
+        i32 j = 3;
+        while (inner(i, j) > k) --j;
+        k -= inner(i, j);
+
+        for (i32 w = i << 4 | j << 2;; ++w) {
+            const u64 x = one ? d[w] : ~d[w];
+            const i32 c = static_cast<i32>(popcnt(x));
+            if (k < c) return w << 6 | static_cast<i32>(select_bit(x, static_cast<usize>(k)));
+
+            k -= c;
+        }
+    }
+};
+
+#endif // LIB_SUCCINCT_BIT_VECTOR_HPP
@@ -2,74 +2,134 @@
 #define LIB_WAVELET_MATRIX_HPP 1
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <numeric>
 #include <optional>
+#include <span>
+#include <tuple>
 #include <vector>
 
 #include <lib/bit_vector.hpp>
+#include <lib/compress.hpp>
+#include <lib/parallel.hpp>
 #include <lib/prelude.hpp>
+#include <lib/static_search.hpp>
 
-template <typename T>
+// BitVector is bit_vector or succinct_bit_vector, Search is sorted_search or eytzinger_search
+template <typename T, typename BitVector = bit_vector, typename Search = sorted_search<T>>
 struct wavelet_matrix {
+    static constexpr u32 SERIAL_TAG = 0x54414d57; // "WMAT"
+
     i32 n, size, log;
     std::vector<T> rv;
     std::vector<i32> md;
-    std::vector<bit_vector> bv;
+    std::vector<BitVector> bv;
+    Search sr;
 
     wavelet_matrix() {}
-    explicit wavelet_matrix(const std::vector<T> &v) {
-        build(v);
+    explicit wavelet_matrix(const std::vector<T> &v, i32 t = 1) {
+        build(v, t);
     }
 
-    void build(const std::vector<T> &v) {
+    // With t threads: the values are compressed with parallel_compress, and every level is a
+    // parallel stable partition, each thread writing from the prefix sums of the zero counts of the
+    // chunks before it
+    // Chunks are whole words, so no two threads set bits in the same word
+    void build(const std::vector<T> &v, i32 t = 1) {
         n = static_cast<i32>(v.size());
+        t = std::clamp(t, 1, std::max(1, n >> 6));
 
-        std::vector<i32> vi(n);
-        std::iota(vi.begin(), vi.end(), 0);
-        std::sort(vi.begin(), vi.end(), [&](const i32 i, const i32 j) { return v[i] == v[j] ? i < j : v[i] < v[j]; });
-
-        rv.reserve(n);
-        std::vector<i32> b(n);
-
-        for (const i32 i : vi) {
-            if (rv.empty() || rv.back() != v[i]) rv.push_back(v[i]);
-            b[i] = static_cast<i32>(rv.size()) - 1;
-        }
-
-        rv.shrink_to_fit();
+        const std::vector<i32> ch = word_chunks(n, t);
+        std::vector<i32> b = parallel_compress(v, rv, t), c(t + 1);
         size = static_cast<i32>(rv.size());
 
+        sr.build(rv);
+
         log = 0;
         while ((1 << log) < size) ++log;
 
         md.resize(log);
-        bv.assign(log, bit_vector(n));
+        bv.assign(log, BitVector(n));
 
-        std::vector<i32> b0(n), b1(n);
+        std::vector<i32> nb(n);
         for (i32 d = log - 1; d >= 0; --d) {
-            i32 p0{}, p1{};
-            for (i32 i = 0; i < n; ++i) {
-                if ((b[i] >> d) & 1) {
-                    bv[d].set(i);
-                    b1[p1++] = b[i];
-                } else {
-                    b0[p0++] = b[i];
+            parallel_for(t, t, [&](u64 j, i32) {
+                i32 z = 0;
+                for (i32 i = ch[j]; i < ch[j + 1]; ++i) z += ~b[i] >> d & 1;
+                c[j + 1] = z;
+            });
+
+            std::partial_sum(c.begin(), c.end(), c.begin());
+            md[d] = c[t];
+
+            parallel_for(t, t, [&](u64 j, i32) {
+                i32 p0 = c[j], p1 = md[d] + ch[j] - c[j];
+                for (i32 i = ch[j]; i < ch[j + 1]; ++i) {
+                    if ((b[i] >> d) & 1) {
+                        bv[d].set(i);
+                        nb[p1++] = b[i];
+                    } else {
+                        nb[p0++] = b[i];
+                    }
                 }
-            }
-
-            std::swap(b, b0);
-            std::move(b1.begin(), b1.begin() + p1, b.begin() + p0);
+            });
 
-            md[d] = p0;
+            std::swap(b, nb);
             bv[d].build();
         }
     }
 
+    // See serialize.hpp
+    template <typename Writer>
+    void save(Writer &w) const {
+        w.value(n);
+        w.value(size);
+        w.value(log);
+        w.array(rv);
+        w.array(md);
+        for (const auto &x : bv) x.save(w);
+    }
+
+    template <typename Reader>
+    bool load(Reader &r) {
+        if (!(r.value(n) && r.value(size) && r.value(log) && r.array(rv) && r.array(md))) return false;
+        if (n < 0 || size < 0 || rv.size() != static_cast<usize>(size) || md.size() != static_cast<usize>(log)) return false;
+
+        i32 k = 0;
+        while ((i64(1) << k) < size) ++k;
+        if (log != k) return false;
+
+        sr.build(rv);
+
+        bv.assign(log, BitVector(0));
+        for (auto &x : bv)
+            if (!x.load(r) || x.n != n) return false;
+
+        // Walks every element down the levels as build laid them out: md must be the zeros of its
+        // level, and every value index reached must be below size, so kth stays inside rv
+        std::vector<i32> c(n), nc(n);
+        for (i32 d = log - 1; d >= 0; --d) {
+            if (bv[d].rank0(n) != md[d]) return false;
+
+            i32 p0 = 0, p1 = md[d];
+            for (i32 i = 0; i < n; ++i) {
+                if (bv[d][i])
+                    nc[p1++] = c[i] | 1 << d;
+                else
+                    nc[p0++] = c[i];
+            }
+
+            std::swap(c, nc);
+        }
+
+        return std::all_of(c.begin(), c.end(), [&](i32 x) { return x < size; });
+    }
+
     i32 count(i32 l, i32 r, T a) const {
         assert(0 <= l && l <= r && r <= n);
 
-        const i32 p = static_cast<i32>(std::lower_bound(rv.begin(), rv.end(), a) - rv.begin());
+        const i32 p = sr.lower_bound(rv, a);
 
         if (l == r || p == 0) return 0;
         if (p == size) return r - l;
@@ -99,6 +159,65 @@ struct wavelet_matrix {
         return count(l, r, b) - count(l, r, a);
     }
 
+    // res[i] := count(l, r, a) for every (l, r, a) = qs[i]
+    // Queries advance together one level at a time in groups of B, and every query prefetches the
+    // words its next level will read, so up to B cache misses are in flight instead of one
+    // Pays off once the levels no longer fit in cache; small matrices are faster with count
+    void count_many(std::span<const std::tuple<i32, i32, T>> qs, std::span<i32> res) const {
+        assert(qs.size() == res.size());
+
+        constexpr usize B = 64;
+        std::array<i32, B> L, R, P, C;
+        std::array<T, B> A;
+
+        for (usize s = 0; s < qs.size(); s += B) {
+            const usize m = std::min(B, qs.size() - s);
+
+            for (usize i = 0; i < m; ++i) A[i] = std::get<2>(qs[s + i]);
+            sr.lower_bound_many(rv, std::span<const T>(A.data(), m), P);
+
+            for (usize i = 0; i < m; ++i) {
+                const auto &[l, r, a] = qs[s + i];
+                assert(0 <= l && l <= r && r <= n);
+
+                L[i] = l;
+                R[i] = r;
+                C[i] = 0;
+
+                if (P[i] == size) {
+                    C[i] = r - l;
+                    L[i] = R[i] = 0;
+                } else if (log > 0) {
+                    bv[log - 1].prefetch(l);
+                    bv[log - 1].prefetch(r);
+                }
+            }
+
+            for (i32 d = log - 1; d >= 0; --d) {
+                for (usize i = 0; i < m; ++i) {
+                    const i32 l0 = bv[d].rank0(L[i]);
+                    const i32 r0 = bv[d].rank0(R[i]);
+
+                    if ((P[i] >> d) & 1) {
+                        C[i] += r0 - l0;
+                        L[i] += md[d] - l0;
+                        R[i] += md[d] - r0;
+                    } else {
+                        L[i] = l0;
+                        R[i] = r0;
+                    }
+
+                    if (d > 0) {
+                        bv[d - 1].prefetch(L[i]);
+                        bv[d - 1].prefetch(R[i]);
+                    }
+                }
+            }
+
+            std::copy(C.begin(), C.begin() + m, res.begin() + s);
+        }
+    }
+
     T kth(i32 l, i32 r, i32 k) const {
         assert(0 <= l && l <= r && r <= n);
         assert(0 <= k && k < r - l);
@@ -125,6 +244,58 @@ struct wavelet_matrix {
         return rv[p];
     }
 
+    // res[i] := kth(l, r, k) for every (l, r, k) = qs[i], in groups of B like count_many
+    void kth_many(std::span<const std::tuple<i32, i32, i32>> qs, std::span<T> res) const {
+        assert(qs.size() == res.size());
+
+        constexpr usize B = 64;
+        std::array<i32, B> L, R, K, P;
+
+        for (usize s = 0; s < qs.size(); s += B) {
+            const usize m = std::min(B, qs.size() - s);
+
+            for (usize i = 0; i < m; ++i) {
+                const auto &[l, r, k] = qs[s + i];
+                assert(0 <= l && l <= r && r <= n);
+                assert(0 <= k && k < r - l);
+
+                L[i] = l;
+                R[i] = r;
+                K[i] = k;
+                P[i] = 0;
+
+                if (log > 0) {
+                    bv[log - 1].prefetch(l);
+                    bv[log - 1].prefetch(r);
+                }
+            }
+
+            for (i32 d = log - 1; d >= 0; --d) {
+                for (usize i = 0; i < m; ++i) {
+                    const i32 l0 = bv[d].rank0(L[i]);
+                    const i32 r0 = bv[d].rank0(R[i]);
+
+                    if (K[i] < r0 - l0) {
+                        L[i] = l0;
+                        R[i] = r0;
+                    } else {
+                        K[i] -= r0 - l0;
+                        L[i] += md[d] - l0;
+                        R[i] += md[d] - r0;
+                        P[i] |= 1 << d;
+                    }
+
+                    if (d > 0) {
+                        bv[d - 1].prefetch(L[i]);
+                        bv[d - 1].prefetch(R[i]);
+                    }
+                }
+            }
+
+            for (usize i = 0; i < m; ++i) res[s + i] = rv[P[i]];
+        }
+    }
+
     T kth(std::vector<std::pair<i32, i32>> segments, i32 k) const {
         i32 cnt{}, p{};
         for (i32 d = log - 1; d >= 0; --d) {
@@ -161,22 +332,22 @@ struct wavelet_matrix {
     }
 
     std::optional<T> next(i32 l, i32 r, T a) const {
-        const auto it = std::upper_bound(rv.begin(), rv.end(), a);
-        if (it == rv.end()) return std::nullopt;
+        const i32 p = sr.upper_bound(rv, a);
+        if (p == size) return std::nullopt;
 
-        const i32 k = count(l, r, *it);
+        const i32 k = count(l, r, rv[p]);
         if (k == r - l) return std::nullopt;
 
         return kth(l, r, k);
     }
 
     std::optional<T> prev(i32 l, i32 r, T a) const {
-        const auto it = std::lower_bound(rv.begin(), rv.end(), a);
+        const i32 p = sr.lower_bound(rv, a);
 
-        if (it == rv.begin()) return std::nullopt;
-        if (it == rv.end()) return kth(l, r, r - l - 1);
+        if (p == 0) return std::nullopt;
+        if (p == size) return kth(l, r, r - l - 1);
 
-        const i32 k = count(l, r, *it);
+        const i32 k = count(l, r, rv[p]);
         if (k == 0) return std::nullopt;
 
         return kth(l, r, k - 1);
@@ -4,13 +4,18 @@
 #include <algorithm>
 #include <cassert>
 #include <numeric>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <lib/algebraic_traits.hpp>
 #include <lib/bit_vector.hpp>
+#include <lib/compress.hpp>
+#include <lib/parallel.hpp>
 #include <lib/prelude.hpp>
 
-template <typename T, typename RangeProduct, is_commutative_monoid_t<typename RangeProduct::MX> * = nullptr>
+template <typename T, typename RangeProduct, typename BitVector = bit_vector,
+          is_commutative_monoid_t<typename RangeProduct::MX> * = nullptr>
 struct wavelet_matrix_product {
     using MX = typename RangeProduct::MX;
     using X = typename MX::ValueT;
@@ -18,67 +23,77 @@ struct wavelet_matrix_product {
     i32 n, size, log;
     std::vector<T> rv;
     std::vector<i32> md;
-    std::vector<bit_vector> bv;
+    std::vector<BitVector> bv;
     std::vector<RangeProduct> sg;
 
     wavelet_matrix_product() {}
-    explicit wavelet_matrix_product(const std::vector<T> &v, std::vector<X> s) {
-        build(v, std::move(s));
+    explicit wavelet_matrix_product(const std::vector<T> &v, std::vector<X> s, i32 t = 1) {
+        build(v, std::move(s), t);
     }
 
-    void build(const std::vector<T> &v, std::vector<X> s) {
+    // Built on t threads like wavelet_matrix; the range product of a level is built on its own
+    // thread while the next level is partitioned
+    void build(const std::vector<T> &v, std::vector<X> s, i32 t = 1) {
         n = static_cast<i32>(v.size());
+        t = std::clamp(t, 1, std::max(1, n >> 6));
 
-        std::vector<i32> vi(n);
-        std::iota(vi.begin(), vi.end(), 0);
-        std::sort(vi.begin(), vi.end(), [&](const i32 i, const i32 j) { return v[i] == v[j] ? i < j : v[i] < v[j]; });
-
-        rv.reserve(n);
-        std::vector<i32> b(n);
-
-        for (const i32 i : vi) {
-            if (rv.empty() || rv.back() != v[i]) rv.push_back(v[i]);
-            b[i] = static_cast<i32>(rv.size()) - 1;
-        }
-
-        rv.shrink_to_fit();
+        const std::vector<i32> ch = word_chunks(n, t);
+        std::vector<i32> b = parallel_compress(v, rv, t), c(t + 1);
         size = static_cast<i32>(rv.size());
 
         log = 0;
         while ((1 << log) < size) ++log;
 
         md.resize(log);
-        bv.assign(log, bit_vector(n));
+        bv.assign(log, BitVector(n));
 
         sg.resize(log + 1);
-        sg[log].build(s);
 
-        std::vector<X> s0(n), s1(n);
-        std::vector<i32> b0(n), b1(n);
+        std::vector<i32> nb(n);
+        std::vector<X> ns(n);
+        std::thread th;
 
-        for (i32 d = log - 1; d >= 0; --d) {
-            i32 p0{}, p1{};
-            for (i32 i = 0; i < n; ++i) {
-                if ((b[i] >> d) & 1) {
-                    bv[d].set(i);
-                    b1[p1] = b[i];
-                    s1[p1] = s[i];
-                    ++p1;
-                } else {
-                    b0[p0] = b[i];
-                    s0[p0] = s[i];
-                    ++p0;
-                }
+        for (i32 d = log; d >= 0; --d) {
+            // s is only read until the swap below
+            if (t > 1) {
+                th = std::thread([&, d]() { sg[d].build(s); });
+            } else {
+                sg[d].build(s);
+            }
+
+            if (d > 0) {
+                const i32 e = d - 1;
+
+                parallel_for(t, t, [&](u64 j, i32) {
+                    i32 z = 0;
+                    for (i32 i = ch[j]; i < ch[j + 1]; ++i) z += ~b[i] >> e & 1;
+                    c[j + 1] = z;
+                });
+
+                std::partial_sum(c.begin(), c.end(), c.begin());
+                md[e] = c[t];
+
+                parallel_for(t, t, [&](u64 j, i32) {
+                    i32 p0 = c[j], p1 = md[e] + ch[j] - c[j];
+                    for (i32 i = ch[j]; i < ch[j + 1]; ++i) {
+                        if ((b[i] >> e) & 1) {
+                            bv[e].set(i);
+                            nb[p1] = b[i];
+                            ns[p1++] = s[i];
+                        } else {
+                            nb[p0] = b[i];
+                            ns[p0++] = s[i];
+                        }
+                    }
+                });
+
+                bv[e].build();
             }
 
-            std::swap(b, b0);
-            std::swap(s, s0);
-            std::move(s1.begin(), s1.begin() + p1, s.begin() + p0);
-            std::move(b1.begin(), b1.begin() + p1, b.begin() + p0);
+            if (th.joinable()) th.join();
 
-            md[d] = p0;
-            bv[d].build();
-            sg[d].build(s);
+            std::swap(b, nb);
+            std::swap(s, ns);
         }
     }
 
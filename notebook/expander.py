@@ -42,6 +42,11 @@ STD_HEADERS = (
     "valarray",
     "iterator",
     "cmath",
+    "thread",
+    "span",
+    "cstring",
+    "istream",
+    "ostream",
 )
 
 STD_HEADER_REGEX = re.compile(rf"#include\s*<({'|'.join(STD_HEADERS)})>\s*")